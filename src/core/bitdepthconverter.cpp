@@ -0,0 +1,180 @@
+#include "bitdepthconverter.h"
+#include <QtMath>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+
+BitDepthConverter::BitDepthConverter(QObject *parent) : QObject(parent)
+{
+	this->target = nullptr;
+	this->conversionRunning = false;
+	this->window = 0;
+	this->level = 0;
+	this->gamma = 1.0;
+	this->logScale = false;
+	this->lutBitDepth = 0;
+	this->rangeMin = 0;
+	this->rangeMax = 0;
+}
+
+BitDepthConverter::~BitDepthConverter()
+{
+}
+
+void BitDepthConverter::setTarget(PreviewSink* target) {
+	this->target = target;
+}
+
+void BitDepthConverter::setDisplayMapping(double window, double level, double gamma, bool logScale) {
+	this->window = window;
+	this->level = level;
+	this->gamma = gamma > 0 ? gamma : 1.0;
+	this->logScale = logScale;
+	this->lutBitDepth = 0; //lookup table is rebuilt with next frame
+}
+
+bool BitDepthConverter::isLinearMapping() const {
+	return !this->logScale && qFuzzyCompare(this->gamma, 1.0);
+}
+
+uchar BitDepthConverter::mapNormalizedValue(qreal normalizedValue) const {
+	qreal value = qBound(0.0, normalizedValue, 1.0);
+	if(this->logScale){
+		value = qLn(1.0 + value*LOG_MAPPING_RANGE)/qLn(1.0 + LOG_MAPPING_RANGE);
+	}
+	if(!qFuzzyCompare(this->gamma, 1.0)){
+		value = qPow(value, 1.0/this->gamma);
+	}
+	return static_cast<uchar>(qRound(value*255.0));
+}
+
+void BitDepthConverter::updateLut(int bitDepth) {
+	if(this->lutBitDepth == bitDepth){
+		return;
+	}
+	this->lutBitDepth = bitDepth;
+
+	//displayed value range
+	qreal maxValue = qPow(2, bitDepth) - 1;
+	if(this->window > 0){
+		this->rangeMin = this->level - this->window/2.0;
+		this->rangeMax = this->level + this->window/2.0;
+	}else{
+		this->rangeMin = 0;
+		this->rangeMax = maxValue;
+	}
+	qreal range = qMax(this->rangeMax - this->rangeMin, 1.0);
+
+	if(bitDepth <= 16){
+		//one entry for every possible input value of the data type, so no clamping is necessary during conversion
+		int lutSize = bitDepth <= 8 ? 256 : 65536;
+		this->lut.resize(lutSize);
+		for(int i = 0; i < lutSize; i++){
+			this->lut[i] = this->mapNormalizedValue((i - this->rangeMin)/range);
+		}
+	}else{
+		//wide data is normalized to WIDE_LUT_SIZE bins of the displayed range, gamma and log mapping are applied by the lookup table
+		this->lut.resize(WIDE_LUT_SIZE);
+		for(int i = 0; i < WIDE_LUT_SIZE; i++){
+			this->lut[i] = this->mapNormalizedValue(static_cast<qreal>(i)/(WIDE_LUT_SIZE-1));
+		}
+	}
+}
+
+void BitDepthConverter::convertWideData(const unsigned int* inputData, uchar* output, int length) {
+	float offset = static_cast<float>(this->rangeMin);
+	float range = static_cast<float>(qMax(this->rangeMax - this->rangeMin, 1.0));
+	bool linear = this->isLinearMapping();
+	float scale = (linear ? 255.0f : static_cast<float>(WIDE_LUT_SIZE-1))/range;
+	float maxOutput = linear ? 255.0f : static_cast<float>(WIDE_LUT_SIZE-1);
+	const uchar* lut = this->lut.constData();
+	int i = 0;
+#ifdef __SSE2__
+	//16 samples per iteration. values are shifted right by one before conversion to float because SSE2 only converts signed integers
+	const __m128 scaleVec = _mm_set1_ps(2.0f*scale);
+	const __m128 halfOffsetVec = _mm_set1_ps(offset/2.0f);
+	const __m128 zeroVec = _mm_setzero_ps();
+	const __m128 maxVec = _mm_set1_ps(maxOutput);
+	for(; i + 16 <= length; i += 16){
+		__m128i indices[4];
+		for(int j = 0; j < 4; j++){
+			__m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&inputData[i+4*j]));
+			__m128 values = _mm_cvtepi32_ps(_mm_srli_epi32(raw, 1));
+			values = _mm_mul_ps(_mm_sub_ps(values, halfOffsetVec), scaleVec);
+			values = _mm_min_ps(_mm_max_ps(values, zeroVec), maxVec);
+			indices[j] = _mm_cvtps_epi32(values);
+		}
+		if(linear){
+			__m128i low = _mm_packs_epi32(indices[0], indices[1]);
+			__m128i high = _mm_packs_epi32(indices[2], indices[3]);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&output[i]), _mm_packus_epi16(low, high));
+		}else{
+			alignas(16) int lutIndices[16];
+			for(int j = 0; j < 4; j++){
+				_mm_store_si128(reinterpret_cast<__m128i*>(&lutIndices[4*j]), indices[j]);
+			}
+			for(int j = 0; j < 16; j++){
+				output[i+j] = lut[lutIndices[j]];
+			}
+		}
+	}
+#endif
+	//remaining samples (or all samples if SSE2 is not available)
+	for(; i < length; i++){
+		float value = qBound(0.0f, (static_cast<float>(inputData[i]) - offset)*scale, maxOutput);
+		int index = static_cast<int>(value + 0.5f);
+		output[i] = linear ? static_cast<uchar>(index) : lut[index];
+	}
+}
+
+void BitDepthConverter::convertDataTo8bit(FrameHandle frame) {
+	if(!this->conversionRunning && !frame.isNull() && this->target != nullptr){
+		this->conversionRunning = true;
+		const FrameInfo& info = frame.getInfo();
+		const void* inputData = frame.constData();
+		int bitDepth = static_cast<int>(info.bitDepth);
+		int length = static_cast<int>(info.width*info.height);
+
+		//invalid frames are reported before the back buffer of the target is opened, error also ends the conversion for the receiver
+		if(bitDepth == 0 || bitDepth > 32 || length == 0){
+			emit error(tr("BitDepthConverter: Invalid data dimensions!"));
+			this->conversionRunning = false;
+			return;
+		}
+
+		//converted data is written directly into the back buffer of the preview item
+		uchar* output8bitData = this->target->beginWrite(static_cast<int>(info.width), static_cast<int>(info.height));
+
+		//lookup table is only rebuilt if bit depth or display mapping changed
+		this->updateLut(bitDepth);
+		const uchar* lut = this->lut.constData();
+
+		//8 bit data with default mapping can be copied directly
+		if (bitDepth == 8 && this->window <= 0 && this->isLinearMapping()){
+			memcpy(output8bitData, inputData, length * sizeof(uchar));
+		}
+		//map to 8 bit with lookup table
+		else if (bitDepth <= 8){
+			const uchar* input = static_cast<const uchar*>(inputData);
+			for(int i=0; i<length; i++){
+				output8bitData[i] = lut[input[i]];
+			}
+		}
+		else if (bitDepth >= 9 && bitDepth <=16){
+			const ushort* input = static_cast<const ushort*>(inputData);
+			for(int i=0; i<length; i++){
+				output8bitData[i] = lut[input[i]];
+			}
+		}
+		else{
+			this->convertWideData(static_cast<const unsigned int*>(inputData), output8bitData, length);
+		}
+
+		this->target->endWrite();
+		emit converted8bitData(frame);
+		this->conversionRunning = false;
+	}
+}
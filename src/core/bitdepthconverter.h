@@ -0,0 +1,51 @@
+#ifndef BITDEPTHCONVERTER_H
+#define BITDEPTHCONVERTER_H
+
+#define WIDE_LUT_SIZE 4096 //number of entries of the lookup table that is used for input data with more than 16 bit
+#define LOG_MAPPING_RANGE 1000.0
+
+#include <QObject>
+#include <QVector>
+#include "framehandle.h"
+#include "previewsink.h"
+
+class BitDepthConverter : public QObject
+{
+	Q_OBJECT
+public:
+	explicit BitDepthConverter(QObject *parent = nullptr);
+	~BitDepthConverter();
+
+	void setTarget(PreviewSink* target);
+
+private:
+	PreviewSink* target;
+	bool conversionRunning;
+
+	//display mapping: window/level in data units (window <= 0 means full range of the bit depth), gamma and optional logarithmic scale
+	qreal window;
+	qreal level;
+	qreal gamma;
+	bool logScale;
+
+	//lookup table from input value (or from WIDE_LUT_SIZE bins of the window for > 16 bit) to 8 bit output value
+	QVector<uchar> lut;
+	int lutBitDepth;
+	qreal rangeMin;
+	qreal rangeMax;
+
+	bool isLinearMapping() const;
+	uchar mapNormalizedValue(qreal normalizedValue) const;
+	void updateLut(int bitDepth);
+	void convertWideData(const unsigned int* inputData, uchar* output, int length);
+
+public slots:
+	void convertDataTo8bit(FrameHandle frame);
+	void setDisplayMapping(double window, double level, double gamma, bool logScale);
+
+signals:
+	void converted8bitData(FrameHandle frame);
+	void info(QString);
+	void error(QString);
+};
+#endif // BITDEPTHCONVERTER_H
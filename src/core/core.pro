@@ -0,0 +1,49 @@
+QT	   = core
+
+TARGET = imagestatisticscore
+TEMPLATE = lib
+CONFIG += staticlib
+
+#library is linked into the plugin (a shared library), so the code has to be position independent
+unix{
+	QMAKE_CXXFLAGS += -fPIC
+}
+
+#library is placed directly in the build directory of this project, also for debug_and_release builds on windows
+DESTDIR = $$shadowed($$PWD)
+
+DEFINES += \
+	QT_DEPRECATED_WARNINGS #emit warnings if depracted Qt features are used
+
+SOURCES += \
+	bitdepthconverter.cpp \
+	imagestatisticscalculator.cpp \
+	framebufferpool.cpp \
+	framehandle.cpp \
+	frameingest.cpp \
+	framecapture.cpp \
+	statisticssnapshot.cpp \
+	statisticshistory.cpp \
+	statisticsrecorder.cpp \
+	statisticskernel.cpp \
+	recordingfile.cpp \
+	statisticssharedmemory.cpp \
+	statisticsmetrics.cpp
+
+HEADERS += \
+	previewsink.h \
+	bitdepthconverter.h \
+	imagestatisticscalculator.h \
+	framebufferpool.h \
+	framehandle.h \
+	frameingest.h \
+	framecapture.h \
+	statisticssnapshot.h \
+	statisticshistory.h \
+	statisticsrecorder.h \
+	statisticssink.h \
+	statisticskernel.h \
+	recordingfile.h \
+	statisticssharedmemory.h \
+	sharedstatisticslayout.h \
+	statisticsmetrics.h
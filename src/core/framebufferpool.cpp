@@ -0,0 +1,168 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#include "framebufferpool.h"
+#include <QMutexLocker>
+#include <cstdlib>
+
+#ifdef Q_OS_WIN
+#include <malloc.h>
+#endif
+#ifdef Q_OS_LINUX
+#include <sys/mman.h>
+#endif
+
+
+FrameBufferPool* FrameBufferPool::instance() {
+	static FrameBufferPool pool;
+	return &pool;
+}
+
+FrameBufferPool::FrameBufferPool()
+{
+	this->cachedBytes = 0;
+#ifdef Q_OS_LINUX
+	this->hugePagesEnabled = true;
+#else
+	this->hugePagesEnabled = false;
+#endif
+	this->totalBytes = 0;
+	this->bytesInUse = 0;
+}
+
+FrameBufferPool::~FrameBufferPool()
+{
+	this->trim();
+}
+
+size_t FrameBufferPool::sizeClass(size_t bytes) {
+	if(bytes <= FRAME_BUFFER_MIN_SIZE_CLASS){
+		return FRAME_BUFFER_MIN_SIZE_CLASS;
+	}
+	//round up to next power of two and use quarter steps below it, so at most 25 % of a buffer is unused
+	size_t powerOfTwo = FRAME_BUFFER_MIN_SIZE_CLASS;
+	while(powerOfTwo < bytes){
+		powerOfTwo <<= 1;
+	}
+	size_t step = powerOfTwo/8;
+	size_t sizeClass = powerOfTwo/2;
+	while(sizeClass < bytes){
+		sizeClass += step;
+	}
+	return sizeClass;
+}
+
+void* FrameBufferPool::acquire(size_t bytes) {
+	size_t size = sizeClass(bytes);
+	QMutexLocker locker(&this->mutex);
+	void* buffer = nullptr;
+	QVector<void*>& freeList = this->freeBuffers[size];
+	if(!freeList.isEmpty()){
+		buffer = freeList.takeLast();
+		this->cachedBytes -= size;
+	}else{
+		buffer = this->allocateAligned(size);
+		if(buffer == nullptr){
+			return nullptr;
+		}
+		this->totalBytes.fetchAndAddRelaxed(size);
+	}
+	this->bufferSizes.insert(buffer, size);
+	this->bytesInUse.fetchAndAddRelaxed(size);
+	return buffer;
+}
+
+void FrameBufferPool::release(void* buffer) {
+	if(buffer == nullptr){
+		return;
+	}
+	QMutexLocker locker(&this->mutex);
+	size_t size = this->bufferSizes.take(buffer);
+	if(size == 0){
+		//buffer was not acquired from this pool
+		return;
+	}
+	this->bytesInUse.fetchAndSubRelaxed(size);
+	if(this->cachedBytes + size > FRAME_BUFFER_MAX_CACHED_BYTES){
+		this->freeAligned(buffer);
+		this->totalBytes.fetchAndSubRelaxed(size);
+		return;
+	}
+	this->freeBuffers[size].append(buffer);
+	this->cachedBytes += size;
+}
+
+void FrameBufferPool::trim() {
+	QMutexLocker locker(&this->mutex);
+	QHash<size_t, QVector<void*>>::iterator it;
+	for(it = this->freeBuffers.begin(); it != this->freeBuffers.end(); ++it){
+		for(void* buffer : it.value()){
+			this->freeAligned(buffer);
+			this->totalBytes.fetchAndSubRelaxed(it.key());
+		}
+	}
+	this->freeBuffers.clear();
+	this->cachedBytes = 0;
+}
+
+void FrameBufferPool::setHugePagesEnabled(bool enable) {
+	QMutexLocker locker(&this->mutex);
+	this->hugePagesEnabled = enable;
+}
+
+bool FrameBufferPool::isHugePagesEnabled() {
+	QMutexLocker locker(&this->mutex);
+	return this->hugePagesEnabled;
+}
+
+void* FrameBufferPool::allocateAligned(size_t bytes) {
+	size_t alignment = bytes >= FRAME_BUFFER_HUGE_PAGE_SIZE ? FRAME_BUFFER_HUGE_PAGE_SIZE : FRAME_BUFFER_ALIGNMENT;
+	void* buffer = nullptr;
+#ifdef Q_OS_WIN
+	buffer = _aligned_malloc(bytes, alignment);
+#else
+	if(posix_memalign(&buffer, alignment, bytes) != 0){
+		buffer = nullptr;
+	}
+#endif
+#ifdef Q_OS_LINUX
+	if(buffer != nullptr && this->hugePagesEnabled && bytes >= FRAME_BUFFER_HUGE_PAGE_SIZE){
+		//only a hint for the kernel, allocation stays valid if transparent huge pages are not available
+		madvise(buffer, bytes, MADV_HUGEPAGE);
+	}
+#endif
+	return buffer;
+}
+
+void FrameBufferPool::freeAligned(void* buffer) {
+#ifdef Q_OS_WIN
+	_aligned_free(buffer);
+#else
+	free(buffer);
+#endif
+}
@@ -0,0 +1,80 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#ifndef FRAMEBUFFERPOOL_H
+#define FRAMEBUFFERPOOL_H
+
+#define FRAME_BUFFER_ALIGNMENT 64
+#define FRAME_BUFFER_HUGE_PAGE_SIZE 2097152
+#define FRAME_BUFFER_MIN_SIZE_CLASS 4096
+#define FRAME_BUFFER_MAX_CACHED_BYTES 536870912 //512 MiB of unused buffers are kept for reuse, larger buffers are freed on release
+
+#include <QMutex>
+#include <QHash>
+#include <QVector>
+#include <QAtomicInteger>
+
+//FrameBufferPool provides 64-byte aligned memory for all frame sized buffers of the extension.
+//Requested sizes are rounded up to size classes (powers of two with quarter steps) and released
+//buffers are kept in per size class free lists, so frame size changes reuse memory instead of
+//calling malloc/free. Buffers of 2 MiB or more are aligned to huge page boundaries and, if huge
+//pages are enabled, marked with madvise(MADV_HUGEPAGE) on Linux.
+class FrameBufferPool
+{
+public:
+	static FrameBufferPool* instance();
+
+	void* acquire(size_t bytes);
+	void release(void* buffer);
+	void trim();
+
+	void setHugePagesEnabled(bool enable);
+	bool isHugePagesEnabled();
+	quint64 getTotalBytes() const {return this->totalBytes.load();}
+	quint64 getBytesInUse() const {return this->bytesInUse.load();}
+
+	static size_t sizeClass(size_t bytes);
+
+private:
+	FrameBufferPool();
+	~FrameBufferPool();
+	Q_DISABLE_COPY(FrameBufferPool)
+
+	void* allocateAligned(size_t bytes);
+	void freeAligned(void* buffer);
+
+	QMutex mutex;
+	QHash<size_t, QVector<void*>> freeBuffers;
+	QHash<void*, size_t> bufferSizes;
+	size_t cachedBytes;
+	bool hugePagesEnabled;
+	QAtomicInteger<quint64> totalBytes;
+	QAtomicInteger<quint64> bytesInUse;
+};
+
+#endif // FRAMEBUFFERPOOL_H
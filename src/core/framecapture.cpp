@@ -0,0 +1,237 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#include "framecapture.h"
+#include <QFileInfo>
+#include <QStorageInfo>
+#include <QThread>
+#include <cstring>
+
+#ifdef Q_OS_UNIX
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#endif
+
+
+FrameCapture::FrameCapture(BUFFER_SOURCE source, QObject* parent) : QObject(parent)
+{
+	this->source = source;
+	this->mapping = nullptr;
+	this->header = nullptr;
+	this->entries = nullptr;
+	this->frameData = nullptr;
+	this->armed.storeRelaxed(0);
+	this->writersInside.storeRelaxed(0);
+	this->writtenFrames = 0;
+	this->formatMismatch = false;
+	this->bitDepth = 0;
+	this->samplesPerLine = 0;
+	this->linesPerFrame = 0;
+}
+
+FrameCapture::~FrameCapture()
+{
+	this->slot_cancel();
+}
+
+QString FrameCapture::getSourceName() const {
+	return this->source == RAW ? tr("Raw") : tr("Processed");
+}
+
+void FrameCapture::slot_setFrameFormat(unsigned int bitDepth, unsigned int samplesPerLine, unsigned int linesPerFrame) {
+	this->bitDepth = bitDepth;
+	this->samplesPerLine = samplesPerLine;
+	this->linesPerFrame = linesPerFrame;
+}
+
+void FrameCapture::slot_start(QString fileName, int frames) {
+	if(this->mapping != nullptr){
+		emit error(this->getSourceName() + ": " + tr("Capture already running!"));
+		return;
+	}
+	if(this->bitDepth == 0 || this->samplesPerLine == 0 || this->linesPerFrame == 0){
+		emit error(this->getSourceName() + ": " + tr("Capture not possible, no frame has been received yet."));
+		return;
+	}
+	quint32 requestedFrames = static_cast<quint32>(qBound(1, frames, FRAME_CAPTURE_MAX_FRAMES));
+	quint64 bytesPerFrame = static_cast<quint64>(this->samplesPerLine)*this->linesPerFrame*FrameHandle::bytesPerSample(this->bitDepth);
+	quint64 tableSize = sizeof(FrameCaptureHeader) + static_cast<quint64>(requestedFrames)*sizeof(FrameCaptureEntry);
+	quint64 dataOffset = ((tableSize+FRAME_CAPTURE_ALIGNMENT-1)/FRAME_CAPTURE_ALIGNMENT)*FRAME_CAPTURE_ALIGNMENT;
+	if(dataOffset + bytesPerFrame*requestedFrames > FRAME_CAPTURE_MAX_BYTES){
+		//the table only gets smaller with fewer frames, so the reduced capture fits as well
+		quint64 maxFrames = dataOffset < FRAME_CAPTURE_MAX_BYTES ? (FRAME_CAPTURE_MAX_BYTES-dataOffset)/bytesPerFrame : 0;
+		if(maxFrames == 0){
+			emit error(this->getSourceName() + ": " + tr("Capture not possible, frame size exceeds capture file size limit."));
+			return;
+		}
+		requestedFrames = static_cast<quint32>(maxFrames);
+		emit info(this->getSourceName() + ": " + tr("Capture file size limit reached, number of frames reduced to ") + QString::number(requestedFrames));
+	}
+	quint64 fileSize = dataOffset + bytesPerFrame*requestedFrames;
+
+	//a full disk would only be noticed when the data callback writes to the mapping
+	QStorageInfo storage(QFileInfo(fileName).absolutePath());
+	if(storage.isValid() && static_cast<quint64>(storage.bytesAvailable()) < fileSize){
+		emit error(this->getSourceName() + ": " + tr("Not enough free disk space for capture. Required: ") + QString::number(fileSize/1048576.0, 'f', 1) + " MiB, " + tr("available: ") + QString::number(storage.bytesAvailable()/1048576.0, 'f', 1) + " MiB");
+		return;
+	}
+
+	this->file.setFileName(fileName);
+	if(!this->file.open(QIODevice::ReadWrite | QIODevice::Truncate) || !this->file.resize(static_cast<qint64>(fileSize))){
+		emit error(this->getSourceName() + ": " + tr("Could not create capture file ") + fileName);
+		this->file.close();
+		return;
+	}
+#ifdef Q_OS_LINUX
+	//reserve the blocks of the file without writing them. file systems without fallocate support allocate the blocks when
+	//the data callback writes them, the free space was checked above
+	if(fallocate(this->file.handle(), 0, 0, static_cast<off_t>(fileSize)) != 0 && errno != EOPNOTSUPP){
+		emit error(this->getSourceName() + ": " + tr("Could not allocate capture file ") + fileName);
+		this->file.close();
+		this->file.remove();
+		return;
+	}
+#endif
+	this->mapping = this->file.map(0, static_cast<qint64>(fileSize));
+	if(this->mapping == nullptr){
+		emit error(this->getSourceName() + ": " + tr("Could not map capture file ") + fileName);
+		this->file.close();
+		return;
+	}
+#ifdef Q_OS_UNIX
+	//pages are prepared by the kernel in the background, the gui thread does not touch the whole file
+	madvise(this->mapping, static_cast<size_t>(fileSize), MADV_WILLNEED);
+#endif
+
+	this->header = reinterpret_cast<FrameCaptureHeader*>(this->mapping);
+	this->entries = reinterpret_cast<FrameCaptureEntry*>(this->mapping + sizeof(FrameCaptureHeader));
+	this->frameData = this->mapping + dataOffset;
+	this->header->magic = FRAME_CAPTURE_MAGIC;
+	this->header->version = FRAME_CAPTURE_VERSION;
+	this->header->source = static_cast<quint32>(this->source);
+	this->header->bitDepth = this->bitDepth;
+	this->header->width = this->samplesPerLine;
+	this->header->height = this->linesPerFrame;
+	this->header->requestedFrames = requestedFrames;
+	this->header->capturedFrames = 0;
+	this->header->bytesPerFrame = bytesPerFrame;
+	this->header->dataOffset = dataOffset;
+	this->header->startTimestamp = 0;
+	this->header->endTimestamp = 0;
+	this->writtenFrames = 0;
+	this->formatMismatch = false;
+
+	this->armed.storeRelease(1);
+	emit info(this->getSourceName() + ": " + tr("Capturing ") + QString::number(requestedFrames) + tr(" frames to ") + fileName);
+	emit captureChanged(true);
+}
+
+void FrameCapture::writeFrames(const char* buffer, unsigned int firstFrame, unsigned int framesPerBuffer, unsigned int bitDepth, unsigned int samplesPerLine, unsigned int linesPerFrame, unsigned int bufferNr) {
+	//called by the data callback. the capture file can only be unmapped after writersInside dropped to zero
+	this->writersInside.ref();
+	if(this->armed.loadAcquire() == 0){
+		this->writersInside.deref();
+		return;
+	}
+	if(bitDepth != this->header->bitDepth || samplesPerLine != this->header->width || linesPerFrame != this->header->height){
+		this->formatMismatch = true;
+		this->disarm();
+		this->writersInside.deref();
+		return;
+	}
+
+	//consecutive frames of the buffer are copied with a single memcpy. the capture starts with the selected frame, all later
+	//buffers are captured from their first frame, so the captured frames are contiguous
+	if(this->writtenFrames > 0){
+		firstFrame = 0;
+	}
+	quint32 frames = qMin(framesPerBuffer-firstFrame, this->header->requestedFrames-this->writtenFrames);
+	size_t bytesPerFrame = static_cast<size_t>(this->header->bytesPerFrame);
+	qint64 timestamp = FrameHandle::currentTimestamp();
+	memcpy(this->frameData + bytesPerFrame*this->writtenFrames, buffer + bytesPerFrame*firstFrame, bytesPerFrame*frames);
+	for(quint32 i = 0; i < frames; i++){
+		FrameCaptureEntry& entry = this->entries[this->writtenFrames+i];
+		entry.timestamp = timestamp;
+		entry.bufferNr = bufferNr;
+		entry.frameNr = firstFrame+i;
+	}
+	if(this->writtenFrames == 0){
+		this->header->startTimestamp = timestamp;
+	}
+	this->header->endTimestamp = timestamp;
+	this->writtenFrames += frames;
+
+	if(this->writtenFrames >= this->header->requestedFrames){
+		this->disarm();
+	}
+	this->writersInside.deref();
+}
+
+void FrameCapture::disarm() {
+	//called by the data callback, the file is closed on the thread of the capture object
+	if(this->armed.testAndSetOrdered(1, 0)){
+		QMetaObject::invokeMethod(this, "slot_finish", Qt::QueuedConnection);
+	}
+}
+
+void FrameCapture::waitForWriters() {
+	//a writer that is still inside only finishes its current memcpy
+	while(this->writersInside.loadAcquire() != 0){
+		QThread::yieldCurrentThread();
+	}
+}
+
+void FrameCapture::slot_cancel() {
+	//if the data callback already disarmed the capture, slot_finish is queued and does nothing when it is called after this.
+	//the ordered exchange pairs with writersInside.ref() in writeFrames, so either the writer sees the capture disarmed or
+	//waitForWriters sees the writer inside
+	this->armed.fetchAndStoreOrdered(0);
+	this->slot_finish();
+}
+
+void FrameCapture::slot_finish() {
+	if(this->mapping == nullptr){
+		return;
+	}
+	this->waitForWriters();
+	this->header->capturedFrames = this->writtenFrames;
+	QString fileName = this->file.fileName();
+	this->file.unmap(this->mapping);
+	this->file.close();
+	this->mapping = nullptr;
+	this->header = nullptr;
+	this->entries = nullptr;
+	this->frameData = nullptr;
+
+	if(this->formatMismatch){
+		emit error(this->getSourceName() + ": " + tr("Frame size changed during capture. Captured frames: ") + QString::number(this->writtenFrames));
+	}
+	emit info(this->getSourceName() + ": " + tr("Capture finished. ") + QString::number(this->writtenFrames) + tr(" frames written to ") + fileName);
+	emit captureChanged(false);
+}
@@ -0,0 +1,111 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#ifndef FRAMECAPTURE_H
+#define FRAMECAPTURE_H
+
+#define FRAME_CAPTURE_MAGIC 0x43534f49 //"IOSC" in little endian byte order
+#define FRAME_CAPTURE_VERSION 1
+#define FRAME_CAPTURE_ALIGNMENT 4096 //frame data starts at a page boundary
+#define FRAME_CAPTURE_MAX_FRAMES 100000
+#define FRAME_CAPTURE_MAX_BYTES (Q_UINT64_C(8)*1024*1024*1024) //8 GiB, the number of captured frames is reduced to stay below this file size
+
+#include <QObject>
+#include <QFile>
+#include <QAtomicInt>
+#include "frameingest.h"
+
+//file layout: FrameCaptureHeader, one FrameCaptureEntry per requested frame, frame data starting at dataOffset.
+//all values are stored in the byte order of the capturing machine (little endian on all supported platforms)
+struct FrameCaptureHeader {
+	quint32 magic;
+	quint32 version;
+	quint32 source; //BUFFER_SOURCE
+	quint32 bitDepth;
+	quint32 width; //samples per line
+	quint32 height; //lines per frame
+	quint32 requestedFrames;
+	quint32 capturedFrames; //written when the capture is finished
+	quint64 bytesPerFrame;
+	quint64 dataOffset;
+	qint64 startTimestamp; //microseconds since epoch
+	qint64 endTimestamp;
+};
+
+struct FrameCaptureEntry {
+	qint64 timestamp; //microseconds since epoch at which the buffer containing the frame was received
+	quint32 bufferNr;
+	quint32 frameNr;
+};
+
+//FrameCapture writes a number of consecutive frames into a preallocated memory-mapped file. The file is prepared on the
+//thread of the capture object, frames are copied by the OCTproZ data callback directly from the received buffer into the mapping.
+class FrameCapture : public QObject
+{
+	Q_OBJECT
+public:
+	explicit FrameCapture(BUFFER_SOURCE source, QObject* parent = nullptr);
+	~FrameCapture();
+
+	bool isActive() const {return this->armed.loadAcquire() != 0;}
+	void writeFrames(const char* buffer, unsigned int firstFrame, unsigned int framesPerBuffer, unsigned int bitDepth, unsigned int samplesPerLine, unsigned int linesPerFrame, unsigned int bufferNr);
+
+private:
+	BUFFER_SOURCE source;
+	QFile file;
+	uchar* mapping;
+	FrameCaptureHeader* header;
+	FrameCaptureEntry* entries;
+	uchar* frameData;
+	QAtomicInt armed;
+	QAtomicInt writersInside;
+	quint32 writtenFrames; //only changed by the data callback while armed
+	bool formatMismatch;
+	unsigned int bitDepth;
+	unsigned int samplesPerLine;
+	unsigned int linesPerFrame;
+
+	void waitForWriters();
+	void disarm();
+	QString getSourceName() const;
+
+signals:
+	void captureChanged(bool active);
+	void info(QString);
+	void error(QString);
+
+public slots:
+	void slot_setFrameFormat(unsigned int bitDepth, unsigned int samplesPerLine, unsigned int linesPerFrame);
+	void slot_start(QString fileName, int frames);
+	void slot_cancel();
+
+private slots:
+	void slot_finish();
+};
+
+#endif // FRAMECAPTURE_H
@@ -0,0 +1,109 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#include "framehandle.h"
+#include "framebufferpool.h"
+#include <chrono>
+#include <new>
+
+//frame header and frame data are placed in one pool buffer, so creating a frame does not need any heap allocation
+struct alignas(FRAME_BUFFER_ALIGNMENT) FrameData {
+	QAtomicInt refCount;
+	FrameInfo info;
+	size_t bytes;
+};
+
+
+FrameHandle::FrameHandle() {
+	this->d = nullptr;
+}
+
+FrameHandle::FrameHandle(const FrameHandle& other) {
+	this->d = other.d;
+	if(this->d != nullptr){
+		this->d->refCount.ref();
+	}
+}
+
+FrameHandle& FrameHandle::operator=(const FrameHandle& other) {
+	if(other.d != nullptr){
+		other.d->refCount.ref();
+	}
+	FrameData* old = this->d;
+	this->d = other.d;
+	if(old != nullptr && !old->refCount.deref()){
+		old->~FrameData();
+		FrameBufferPool::instance()->release(old);
+	}
+	return *this;
+}
+
+FrameHandle::~FrameHandle() {
+	if(this->d != nullptr && !this->d->refCount.deref()){
+		this->d->~FrameData();
+		FrameBufferPool::instance()->release(this->d);
+	}
+}
+
+FrameHandle FrameHandle::create(const FrameInfo& info) {
+	FrameHandle frame;
+	size_t bytes = static_cast<size_t>(info.width)*info.height*bytesPerSample(info.bitDepth);
+	void* buffer = FrameBufferPool::instance()->acquire(sizeof(FrameData)+bytes);
+	if(buffer == nullptr){
+		return frame;
+	}
+	frame.d = new (buffer) FrameData();
+	frame.d->refCount.storeRelaxed(1);
+	frame.d->info = info;
+	frame.d->bytes = bytes;
+	return frame;
+}
+
+qint64 FrameHandle::currentTimestamp() {
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+size_t FrameHandle::bytesPerSample(unsigned int bitDepth) {
+	return (bitDepth+7)/8;
+}
+
+const FrameInfo& FrameHandle::getInfo() const {
+	return this->d->info;
+}
+
+const void* FrameHandle::constData() const {
+	return reinterpret_cast<const char*>(this->d) + sizeof(FrameData);
+}
+
+void* FrameHandle::writableData() {
+	return reinterpret_cast<char*>(this->d) + sizeof(FrameData);
+}
+
+size_t FrameHandle::getSizeInBytes() const {
+	return this->d == nullptr ? 0 : this->d->bytes;
+}
@@ -0,0 +1,77 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#ifndef FRAMEHANDLE_H
+#define FRAMEHANDLE_H
+
+#include <QAtomicInt>
+#include <QMetaType>
+
+struct FrameInfo {
+	unsigned int bitDepth;
+	unsigned int width; //samples per line of the data stored in the frame
+	unsigned int height; //lines of the data stored in the frame
+	int x; //position of the first stored sample within the acquired frame
+	int y;
+	unsigned int decimation; //only every decimation-th sample and line of the acquired frame is stored
+	unsigned int frameWidth; //samples per line of the acquired frame
+	unsigned int frameHeight; //lines per frame of the acquired frame
+	quint64 sequenceNumber;
+	qint64 timestamp; //microseconds since epoch at which the frame was received
+};
+
+struct FrameData;
+
+//FrameHandle is a reference counted handle to an immutable frame. The frame memory is acquired from
+//FrameBufferPool and returned to it as soon as the last handle is destroyed. A frame must only be
+//written via writableData() by its creator before the handle is passed on to other threads.
+class FrameHandle
+{
+public:
+	FrameHandle();
+	FrameHandle(const FrameHandle& other);
+	FrameHandle& operator=(const FrameHandle& other);
+	~FrameHandle();
+
+	static FrameHandle create(const FrameInfo& info);
+	static qint64 currentTimestamp();
+	static size_t bytesPerSample(unsigned int bitDepth);
+
+	bool isNull() const {return this->d == nullptr;}
+	const FrameInfo& getInfo() const;
+	const void* constData() const;
+	void* writableData();
+	size_t getSizeInBytes() const;
+
+private:
+	FrameData* d;
+};
+
+Q_DECLARE_METATYPE(FrameHandle)
+
+#endif // FRAMEHANDLE_H
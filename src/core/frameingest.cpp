@@ -0,0 +1,275 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#include "frameingest.h"
+#include "framebufferpool.h"
+#include "framecapture.h"
+#include "statisticsmetrics.h"
+#include <climits>
+#include <cstring>
+
+
+FrameIngest::FrameIngest(BUFFER_SOURCE source, QObject *parent) : QObject(parent)
+{
+	this->source = source;
+	this->parameters.enabled = false;
+	this->parameters.frameNr = 0;
+	this->parameters.bufferNr = 0;
+	this->parameters.roi.setRect(0, 0, 0, 0);
+	this->parameters.previewEnabled = false;
+	this->parameters.previewWidth = 0;
+	this->parameters.previewHeight = 0;
+	this->parameters.previewRegion.setRect(0, 0, 0, 0);
+	this->parameters.previewDecimation = 1;
+	this->isCalculating = false;
+	this->lostBuffers = 0;
+	this->framesPerBuffer = 0;
+	this->buffersPerVolume = 0;
+	this->bytesPerFrame = 0;
+	this->bitDepth = 0;
+	this->samplesPerLine = 0;
+	this->linesPerFrame = 0;
+	this->frameSequenceNumber = 0;
+	this->capture = nullptr;
+	this->metrics = nullptr;
+}
+
+void FrameIngest::setEnabled(bool enabled) {
+	QMutexLocker locker(&this->parametersMutex);
+	this->parameters.enabled = enabled;
+}
+
+void FrameIngest::setFrameNr(int frameNr) {
+	QMutexLocker locker(&this->parametersMutex);
+	this->parameters.frameNr = frameNr;
+}
+
+void FrameIngest::setBufferNr(int bufferNr) {
+	QMutexLocker locker(&this->parametersMutex);
+	this->parameters.bufferNr = bufferNr;
+}
+
+void FrameIngest::setROI(int x, int y, int width, int height) {
+	QMutexLocker locker(&this->parametersMutex);
+	this->parameters.roi = QRect(x, y, width, height).normalized();
+}
+
+void FrameIngest::setPreviewEnabled(bool enabled) {
+	QMutexLocker locker(&this->parametersMutex);
+	this->parameters.previewEnabled = enabled;
+}
+
+void FrameIngest::setPreviewSize(int width, int height) {
+	QMutexLocker locker(&this->parametersMutex);
+	this->parameters.previewWidth = width;
+	this->parameters.previewHeight = height;
+}
+
+void FrameIngest::setPreviewRegion(int x, int y, int width, int height, int decimation) {
+	QMutexLocker locker(&this->parametersMutex);
+	this->parameters.previewRegion = QRect(x, y, width, height);
+	this->parameters.previewDecimation = static_cast<unsigned int>(qMax(1, decimation));
+}
+
+IngestParameters FrameIngest::getParameters() const {
+	QMutexLocker locker(&this->parametersMutex);
+	return this->parameters;
+}
+
+QString FrameIngest::getSourceName() const {
+	return this->source == RAW ? tr("Raw") : tr("Processed");
+}
+
+void FrameIngest::receiveBuffer(void* buffer, unsigned int bitDepth, unsigned int samplesPerLine, unsigned int linesPerFrame, unsigned int framesPerBuffer, unsigned int buffersPerVolume, unsigned int currentBufferNr) {
+	//one consistent copy of the gui parameters is used for the whole buffer
+	IngestParameters parameters = this->getParameters();
+	if(!parameters.enabled){
+		return;
+	}
+	//every buffer is counted as received, also the ones that are lost because the previous buffer is still processed
+	if(this->metrics != nullptr){
+		this->metrics->addReceivedFrame();
+	}
+	if(this->isCalculating){
+		this->countLostBuffer();
+		return;
+	}
+	this->isCalculating = true;
+	qint64 receiveTimestamp = 0;
+	if(this->metrics != nullptr){
+		receiveTimestamp = FrameHandle::currentTimestamp();
+	}
+
+	//check if number of frames per buffer has changed and emit maxFrames to update gui
+	if(this->framesPerBuffer != framesPerBuffer){
+		emit maxFrames(framesPerBuffer-1);
+		this->framesPerBuffer = framesPerBuffer;
+	}
+	//check if number of buffers per volume has changed and emit maxBuffers to update gui
+	if(this->buffersPerVolume != buffersPerVolume){
+		emit maxBuffers(buffersPerVolume-1);
+		this->buffersPerVolume = buffersPerVolume;
+	}
+
+	//check if current buffer is selected. If it is not selected discard it and do nothing
+	if(parameters.bufferNr>static_cast<int>(buffersPerVolume-1)){parameters.bufferNr = static_cast<int>(buffersPerVolume-1);}
+	if(!(parameters.bufferNr == -1 || parameters.bufferNr == static_cast<int>(currentBufferNr))){
+		this->isCalculating = false;
+		return;
+	}
+
+	//calculate size of single frame
+	size_t bytesPerFrame = samplesPerLine*linesPerFrame*FrameHandle::bytesPerSample(bitDepth);
+
+	//check if frame size changed, frame copies are taken from the frame buffer pool with matching size
+	if(this->bytesPerFrame != bytesPerFrame){
+		if(bitDepth == 0 || samplesPerLine == 0 || linesPerFrame == 0 || framesPerBuffer == 0){
+			emit error(this->getSourceName() + ": " + tr("Invalid data dimensions!"));
+			this->isCalculating = false;
+			return;
+		}
+		this->bytesPerFrame = bytesPerFrame;
+		emit info(this->getSourceName() + ": " + tr("Frame size changed. Frame buffer pool size: ") + QString::number(FrameBufferPool::instance()->getTotalBytes()/1048576.0, 'f', 1) + " MiB");
+	}
+	if(this->bitDepth != bitDepth || this->samplesPerLine != samplesPerLine || this->linesPerFrame != linesPerFrame){
+		this->bitDepth = bitDepth;
+		this->samplesPerLine = samplesPerLine;
+		this->linesPerFrame = linesPerFrame;
+		emit frameFormatChanged(bitDepth, samplesPerLine, linesPerFrame);
+	}
+
+	//copy roi (and preview) of single frame of received data and emit it for further processing
+	const char* frameInBuffer = static_cast<const char*>(buffer);
+	if(parameters.frameNr>static_cast<int>(framesPerBuffer-1)){parameters.frameNr = static_cast<int>(framesPerBuffer-1);}
+	if(this->capture != nullptr && this->capture->isActive()){
+		this->capture->writeFrames(frameInBuffer, static_cast<unsigned int>(parameters.frameNr), framesPerBuffer, bitDepth, samplesPerLine, linesPerFrame, currentBufferNr);
+	}
+	this->emitFrameCopies(&(frameInBuffer[bytesPerFrame*parameters.frameNr]), bitDepth, samplesPerLine, linesPerFrame, parameters);
+	if(this->metrics != nullptr){
+		this->metrics->addLatency(INGEST_STAGE, FrameHandle::currentTimestamp()-receiveTimestamp);
+	}
+
+	this->isCalculating = false;
+}
+
+void FrameIngest::reportLostBuffer() {
+	//buffers that are discarded before receiveBuffer are received and lost
+	if(!this->isEnabled()){
+		return;
+	}
+	if(this->metrics != nullptr){
+		this->metrics->addReceivedFrame();
+	}
+	this->countLostBuffer();
+}
+
+void FrameIngest::countLostBuffer() {
+	this->lostBuffers++;
+	if(this->metrics != nullptr){
+		this->metrics->addLostFrame();
+	}
+	emit info(this->getSourceName() + ": " + tr("Buffer lost. Total lost buffers: ") + QString::number(this->lostBuffers));
+	if(this->lostBuffers >= INT_MAX){
+		this->lostBuffers = 0;
+		emit info(this->getSourceName() + ": " + tr("Lost buffer counter overflow. Counter set to zero."));
+	}
+}
+
+void FrameIngest::emitFrameCopies(const char* frameInBuffer, unsigned int bitDepth, unsigned int samplesPerLine, unsigned int linesPerFrame, const IngestParameters& parameters) {
+	size_t bytesPerSample = FrameHandle::bytesPerSample(bitDepth);
+	FrameInfo info;
+	info.bitDepth = bitDepth;
+	info.frameWidth = samplesPerLine;
+	info.frameHeight = linesPerFrame;
+	info.sequenceNumber = this->frameSequenceNumber++;
+	info.timestamp = FrameHandle::currentTimestamp();
+
+	//copy only the row spans of the roi (and a margin around it) for statistics calculation
+	QRect marginRect = parameters.roi.adjusted(-ROI_COPY_MARGIN, -ROI_COPY_MARGIN, ROI_COPY_MARGIN, ROI_COPY_MARGIN);
+	QRect region = marginRect.intersected(QRect(0, 0, static_cast<int>(samplesPerLine), static_cast<int>(linesPerFrame)));
+	if(!region.isEmpty()){
+		info.width = static_cast<unsigned int>(region.width());
+		info.height = static_cast<unsigned int>(region.height());
+		info.x = region.x();
+		info.y = region.y();
+		info.decimation = 1;
+		FrameHandle roiFrame = FrameHandle::create(info);
+		if(roiFrame.isNull()){
+			emit error(this->getSourceName() + ": " + tr("Could not allocate frame buffer!"));
+			return;
+		}
+		char* roiBuffer = static_cast<char*>(roiFrame.writableData());
+		size_t bytesPerRoiLine = info.width*bytesPerSample;
+		for(int y = 0; y < region.height(); y++){
+			size_t srcOffset = (static_cast<size_t>(region.y()+y)*samplesPerLine + static_cast<size_t>(region.x()))*bytesPerSample;
+			memcpy(&(roiBuffer[bytesPerRoiLine*y]), &(frameInBuffer[srcOffset]), bytesPerRoiLine);
+		}
+		emit newRoiFrame(roiFrame);
+	}
+
+	//copy the part of the frame that is visible in the preview, decimated to the level of detail of the current zoom level
+	if(parameters.previewEnabled){
+		QRect frameRect(0, 0, static_cast<int>(samplesPerLine), static_cast<int>(linesPerFrame));
+		QRect previewRegion = parameters.previewRegion.intersected(frameRect);
+		unsigned int decimation = parameters.previewDecimation;
+		if(previewRegion.isEmpty()){
+			//visible region is not known yet (or the view does not show the frame), fit whole frame into preview widget
+			previewRegion = frameRect;
+			decimation = 1;
+			if(parameters.previewWidth > 0 && parameters.previewHeight > 0){
+				decimation = qMax(1u, qMax(samplesPerLine/static_cast<unsigned int>(parameters.previewWidth), linesPerFrame/static_cast<unsigned int>(parameters.previewHeight)));
+			}
+		}
+		info.width = (static_cast<unsigned int>(previewRegion.width())+decimation-1)/decimation;
+		info.height = (static_cast<unsigned int>(previewRegion.height())+decimation-1)/decimation;
+		info.x = previewRegion.x();
+		info.y = previewRegion.y();
+		info.decimation = decimation;
+		FrameHandle previewFrame = FrameHandle::create(info);
+		if(previewFrame.isNull()){
+			emit error(this->getSourceName() + ": " + tr("Could not allocate frame buffer!"));
+			return;
+		}
+		char* previewBuffer = static_cast<char*>(previewFrame.writableData());
+		size_t bytesPerRegionLine = static_cast<size_t>(previewRegion.width())*bytesPerSample;
+		char* dst = previewBuffer;
+		for(int y = previewRegion.top(); y <= previewRegion.bottom(); y += static_cast<int>(decimation)){
+			const char* srcLine = &(frameInBuffer[(static_cast<size_t>(y)*samplesPerLine + static_cast<size_t>(previewRegion.x()))*bytesPerSample]);
+			if(decimation == 1){
+				memcpy(dst, srcLine, bytesPerRegionLine);
+				dst += bytesPerRegionLine;
+			}else{
+				for(int x = 0; x < previewRegion.width(); x += static_cast<int>(decimation)){
+					memcpy(dst, &(srcLine[x*bytesPerSample]), bytesPerSample);
+					dst += bytesPerSample;
+				}
+			}
+		}
+		emit newPreviewFrame(previewFrame);
+	}
+}
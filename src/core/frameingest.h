@@ -0,0 +1,117 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#ifndef FRAMEINGEST_H
+#define FRAMEINGEST_H
+
+#include <QObject>
+#include <QMutex>
+#include <QRect>
+#include "framehandle.h"
+
+class FrameCapture;
+class StatisticsMetrics;
+
+#define ROI_COPY_MARGIN 64 //samples around the roi that are copied as well, so small roi changes can be evaluated with the last frame
+
+enum BUFFER_SOURCE{
+	RAW,
+	PROCESSED,
+	RAW_AND_PROCESSED
+};
+
+//parameters set from the gui thread. receiveBuffer copies them once per buffer, so a buffer is never processed with a half updated set
+struct IngestParameters {
+	bool enabled;
+	int frameNr;
+	int bufferNr;
+	QRect roi;
+	bool previewEnabled;
+	int previewWidth;
+	int previewHeight;
+	QRect previewRegion;
+	unsigned int previewDecimation;
+};
+
+//FrameIngest is called from the OCTproZ data callbacks. It selects a single frame of the received
+//buffer, copies the roi (and a preview sized version of the frame if requested) into frame handles
+//and emits them for further processing. There is one FrameIngest instance per buffer source.
+class FrameIngest : public QObject
+{
+	Q_OBJECT
+public:
+	explicit FrameIngest(BUFFER_SOURCE source, QObject *parent = nullptr);
+
+	BUFFER_SOURCE getSource() const {return this->source;}
+	bool isEnabled() const {return this->getParameters().enabled;}
+	void receiveBuffer(void* buffer, unsigned int bitDepth, unsigned int samplesPerLine, unsigned int linesPerFrame, unsigned int framesPerBuffer, unsigned int buffersPerVolume, unsigned int currentBufferNr);
+	void reportLostBuffer();
+	void setCapture(FrameCapture* capture){this->capture = capture;}
+	void setMetrics(StatisticsMetrics* metrics){this->metrics = metrics;}
+
+private:
+	BUFFER_SOURCE source;
+	mutable QMutex parametersMutex;
+	IngestParameters parameters;
+	bool isCalculating;
+	int lostBuffers;
+	unsigned int framesPerBuffer;
+	unsigned int buffersPerVolume;
+	size_t bytesPerFrame;
+	unsigned int bitDepth;
+	unsigned int samplesPerLine;
+	unsigned int linesPerFrame;
+	quint64 frameSequenceNumber;
+	FrameCapture* capture;
+	StatisticsMetrics* metrics;
+
+	QString getSourceName() const;
+	IngestParameters getParameters() const;
+	void countLostBuffer();
+	void emitFrameCopies(const char* frameInBuffer, unsigned int bitDepth, unsigned int samplesPerLine, unsigned int linesPerFrame, const IngestParameters& parameters);
+
+public slots:
+	void setEnabled(bool enabled);
+	void setFrameNr(int frameNr);
+	void setBufferNr(int bufferNr);
+	void setROI(int x, int y, int width, int height);
+	void setPreviewEnabled(bool enabled);
+	void setPreviewSize(int width, int height);
+	void setPreviewRegion(int x, int y, int width, int height, int decimation);
+
+signals:
+	void newRoiFrame(FrameHandle roiFrame);
+	void newPreviewFrame(FrameHandle previewFrame);
+	void maxFrames(int max);
+	void maxBuffers(int max);
+	void frameFormatChanged(unsigned int bitDepth, unsigned int samplesPerLine, unsigned int linesPerFrame);
+	void info(QString);
+	void error(QString);
+};
+
+#endif // FRAMEINGEST_H
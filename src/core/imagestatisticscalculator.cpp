@@ -0,0 +1,124 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+#include "imagestatisticscalculator.h"
+
+
+ImageStatisticsCalculator::ImageStatisticsCalculator(QObject *parent) : QObject(parent)
+{
+	this->calculationRunnging = false;
+	this->recalculationPending = false;
+	this->roi.setRect(0, 0, 0, 0);
+	this->source = RAW;
+	this->metrics = nullptr;
+}
+
+void ImageStatisticsCalculator::addSink(StatisticsSink* sink) {
+	//must be called before the calculator receives frames
+	this->sinks.append(sink);
+}
+
+void ImageStatisticsCalculator::slot_calculateStatistics(FrameHandle roiFrame) {
+	if(roiFrame.isNull()){
+		return;
+	}
+	if(this->calculationRunnging){
+		if(this->metrics != nullptr){
+			this->metrics->addDroppedFrame();
+		}
+		return;
+	}
+	this->lastFrame = roiFrame;
+	this->calculate(true);
+}
+
+void ImageStatisticsCalculator::slot_setROI(int x, int y, int width, int height) {
+	//statistics of the new roi are available immediately, also if acquisition is paused or slow
+	this->roi = QRect(x, y, width, height).normalized();
+	if(this->calculationRunnging){
+		this->recalculationPending = true;
+	}else if(!this->lastFrame.isNull()){
+		this->calculate(false);
+	}
+}
+
+void ImageStatisticsCalculator::calculate(bool newFrame) {
+	//latencies are only measured for new frames, recalculations after roi changes reuse the last frame
+	this->calculationRunnging = true;
+	bool measure = newFrame && this->metrics != nullptr;
+	qint64 startTimestamp = measure ? FrameHandle::currentTimestamp() : 0;
+	const FrameInfo& info = this->lastFrame.getInfo();
+	const void* frameBuffer = this->lastFrame.constData();
+	unsigned int bitDepth = info.bitDepth;
+
+	//frames contain the roi and a margin around it. only the part of the roi that is inside the stored frame region can be evaluated
+	QRect frameRegion(info.x, info.y, static_cast<int>(info.width), static_cast<int>(info.height));
+	QRect roiRegion = this->roi.isEmpty() ? frameRegion : this->roi.intersected(frameRegion);
+	if(roiRegion.isEmpty()){
+		this->calculationRunnging = false;
+		return;
+	}
+	QRect region = roiRegion.translated(-info.x, -info.y);
+	size_t stride = info.width;
+
+	//results are written into a recycled snapshot that is published when it is complete
+	StatisticsSnapshotData* snapshot = this->snapshotPool.beginWrite();
+	snapshot->frameSequenceNumber = info.sequenceNumber;
+	snapshot->timestamp = info.timestamp;
+	snapshot->statistics.roiX = roiRegion.x();
+	snapshot->statistics.roiY = roiRegion.y();
+	snapshot->statistics.roiWidth = roiRegion.width();
+	snapshot->statistics.roiHeight = roiRegion.height();
+
+	//roi statistics and histogram are calculated by the same kernel that is used by the command line tools
+	StatisticsKernel::calculate(frameBuffer, bitDepth, stride, region, nullptr, 0, &snapshot->statistics, &snapshot->histogram);
+	qint64 calculatedTimestamp = measure ? FrameHandle::currentTimestamp() : 0;
+
+	//results are not pushed to the gui, the gui pulls the latest snapshot with its own refresh rate
+	this->history.append(StatisticsHistory::sampleFromStatistics(snapshot->timestamp, snapshot->statistics));
+	this->snapshotPool.publish(snapshot);
+
+	//the published snapshot is only recycled by this thread, so it can still be read here. sinks never block on I/O
+	for(StatisticsSink* sink : qAsConst(this->sinks)){
+		sink->record(this->source, snapshot);
+	}
+	if(measure){
+		this->metrics->addLatency(QUEUE_STAGE, startTimestamp-info.timestamp);
+		this->metrics->addLatency(CALCULATION_STAGE, calculatedTimestamp-startTimestamp);
+		this->metrics->addLatency(END_TO_END_STAGE, FrameHandle::currentTimestamp()-info.timestamp);
+		this->metrics->addProcessedFrame();
+	}
+
+	QCoreApplication::processEvents();
+	this->calculationRunnging = false;
+
+	//roi changed during calculation
+	if(this->recalculationPending){
+		this->recalculationPending = false;
+		this->calculate(false);
+	}
+}
@@ -28,27 +28,17 @@
 #ifndef IMAGESTATISTICSCALCULATOR_H
 #define IMAGESTATISTICSCALCULATOR_H
 
-#define NUMBER_OF_HISTOGRAM_BUFFERS 2
-
 #include <QObject>
 #include <QVector>
 #include <QRect>
-#include <QApplication>
+#include <QCoreApplication>
 #include <QtMath>
-
-struct ImageStatistics {
-	int pixels;
-	qreal max;
-	qreal min;
-	qreal sum;
-	qreal average;
-	qreal stdDeviation;
-	qreal coeffOfVariation;
-	int roiX;
-	int roiY;
-	int roiWidth;
-	int roiHeight;
-};
+#include "framehandle.h"
+#include "statisticssnapshot.h"
+#include "statisticshistory.h"
+#include "statisticssink.h"
+#include "statisticskernel.h"
+#include "statisticsmetrics.h"
 
 class ImageStatisticsCalculator : public QObject
 {
@@ -56,27 +46,32 @@ class ImageStatisticsCalculator : public QObject
 public:
 	explicit ImageStatisticsCalculator(QObject *parent = nullptr);
 
+	StatisticsSnapshot getLatestSnapshot() const {return this->snapshotPool.latest();}
+	const StatisticsHistory* getHistory() const {return &this->history;}
+	void setSource(BUFFER_SOURCE source){this->source = source;}
+	void addSink(StatisticsSink* sink);
+	void setMetrics(StatisticsMetrics* metrics){this->metrics = metrics;}
+
 private:
 	bool calculationRunnging;
-	ImageStatistics stats;
-	QVector<qreal> histogramX;
-	QVector<QVector<qreal>> histogramY;
-	int currHistogramBufferID;
-	QRect roi;
+	bool recalculationPending;
+	StatisticsSnapshotPool snapshotPool;
+	StatisticsHistory history;
+	FrameHandle lastFrame; //last received frame, statistics are recalculated with it when the roi changes
+	QRect roi; //roi in coordinates of the acquired frame
+	BUFFER_SOURCE source; //passed to the sinks
+	QVector<StatisticsSink*> sinks;
+	StatisticsMetrics* metrics;
 
-	QPoint indexToPoint(int index, int width);
-	qreal standardDeviation(QVector<qreal> samples, qreal mean);
-	template <typename T> void calculateStatistics(T frame, unsigned int bitDepth, unsigned int samplesPerLine, unsigned int linesPerFrame);
+	void calculate(bool newFrame);
 
 
 signals:
-	void statisticsCalculated(ImageStatistics*);
-	void histogramCalculated(QVector<qreal>* x, QVector<qreal>* y);
 	void info(QString);
 	void error(QString);
 
 public slots:
-	void slot_calculateStatistics(void* frameBuffer, unsigned int bitDepth, unsigned int samplesPerLine, unsigned int linesPerFrame);
+	void slot_calculateStatistics(FrameHandle roiFrame);
 	void slot_setROI(int x, int y, int width, int height);
 };
 
@@ -0,0 +1,16 @@
+#include this file to link the static core library. the library has to be built before, see octproz-image-statistics-extension.pro
+IMAGESTATISTICSCORE_DIR = $$shadowed($$PWD)
+
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+LIBS += -L$$IMAGESTATISTICSCORE_DIR -limagestatisticscore
+
+win32{
+	PRE_TARGETDEPS += $$shell_path($$IMAGESTATISTICSCORE_DIR/imagestatisticscore.lib)
+}
+unix{
+	PRE_TARGETDEPS += $$shell_path($$IMAGESTATISTICSCORE_DIR/libimagestatisticscore.a)
+}
+unix:!macx{
+	LIBS += -lrt #shm_open for StatisticsSharedMemory
+}
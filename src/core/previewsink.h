@@ -0,0 +1,44 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#ifndef PREVIEWSINK_H
+#define PREVIEWSINK_H
+
+#include <QtGlobal>
+
+//receiver of 8 bit preview images written by BitDepthConverter. beginWrite returns a buffer for width*height pixels
+//that stays valid until endWrite is called. Both methods are called by the converter thread.
+class PreviewSink
+{
+public:
+	virtual ~PreviewSink() {}
+	virtual uchar* beginWrite(int width, int height) = 0;
+	virtual void endWrite() = 0;
+};
+
+#endif // PREVIEWSINK_H
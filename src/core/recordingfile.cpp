@@ -0,0 +1,156 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#include "recordingfile.h"
+#include "framecapture.h"
+#include <QCoreApplication>
+#include <cstring>
+#include <limits>
+
+
+RecordingFile::RecordingFile()
+{
+	this->mapping = nullptr;
+	this->frameData = nullptr;
+	this->captureHeader = false;
+	this->source = PROCESSED;
+	this->bitDepth = 0;
+	this->samplesPerLine = 0;
+	this->linesPerFrame = 0;
+	this->bytesPerFrame = 0;
+	this->numberOfFrames = 0;
+}
+
+RecordingFile::~RecordingFile()
+{
+	this->close();
+}
+
+bool RecordingFile::open(const QString& fileName, unsigned int bitDepth, unsigned int samplesPerLine, unsigned int linesPerFrame, BUFFER_SOURCE source) {
+	this->close();
+	this->file.setFileName(fileName);
+	if(!this->file.open(QIODevice::ReadOnly)){
+		this->errorString = QCoreApplication::translate("RecordingFile", "Could not open ") + fileName;
+		return false;
+	}
+	qint64 fileSize = this->file.size();
+	this->mapping = fileSize > 0 ? this->file.map(0, fileSize) : nullptr;
+	if(this->mapping == nullptr){
+		this->errorString = QCoreApplication::translate("RecordingFile", "Could not map ") + fileName;
+		this->close();
+		return false;
+	}
+
+	this->captureHeader = this->readCaptureHeader(fileSize);
+	if(!this->captureHeader){
+		if(!this->errorString.isEmpty()){
+			this->close();
+			return false;
+		}
+		if(bitDepth == 0 || samplesPerLine == 0 || linesPerFrame == 0){
+			this->errorString = QCoreApplication::translate("RecordingFile", "Bit depth, samples per line and lines per frame are needed for a recording without capture header: ") + fileName;
+			this->close();
+			return false;
+		}
+		if(bitDepth > 32){
+			this->errorString = QCoreApplication::translate("RecordingFile", "Bit depth must not exceed 32: ") + fileName;
+			this->close();
+			return false;
+		}
+		this->source = source;
+		this->bitDepth = bitDepth;
+		this->samplesPerLine = samplesPerLine;
+		this->linesPerFrame = linesPerFrame;
+		this->bytesPerFrame = static_cast<size_t>(samplesPerLine)*linesPerFrame*FrameHandle::bytesPerSample(bitDepth);
+		this->frameData = this->mapping;
+		this->numberOfFrames = static_cast<quint64>(fileSize)/this->bytesPerFrame;
+	}
+	if(this->numberOfFrames == 0){
+		this->errorString = QCoreApplication::translate("RecordingFile", "Recording does not contain a complete frame: ") + fileName;
+		this->close();
+		return false;
+	}
+	return true;
+}
+
+void RecordingFile::close() {
+	if(this->mapping != nullptr){
+		this->file.unmap(this->mapping);
+		this->mapping = nullptr;
+	}
+	this->file.close();
+	this->frameData = nullptr;
+	this->numberOfFrames = 0;
+}
+
+bool RecordingFile::readCaptureHeader(qint64 fileSize) {
+	this->errorString.clear();
+	if(fileSize < static_cast<qint64>(sizeof(FrameCaptureHeader))){
+		return false;
+	}
+	FrameCaptureHeader header;
+	memcpy(&header, this->mapping, sizeof(FrameCaptureHeader));
+	if(header.magic != FRAME_CAPTURE_MAGIC){
+		return false;
+	}
+	if(header.version != FRAME_CAPTURE_VERSION){
+		this->errorString = QCoreApplication::translate("RecordingFile", "Unsupported capture file version: ") + this->file.fileName();
+		return false;
+	}
+
+	//all header fields are checked before frames are read from the mapping. sizes are compared by division, so a corrupted
+	//header can not overflow the calculation
+	quint64 size = static_cast<quint64>(fileSize);
+	quint64 tableSize = sizeof(FrameCaptureHeader) + static_cast<quint64>(header.requestedFrames)*sizeof(FrameCaptureEntry);
+	bool valid = header.source <= PROCESSED
+			&& header.bitDepth >= 1 && header.bitDepth <= 32
+			&& header.width > 0 && header.height > 0
+			&& header.capturedFrames <= header.requestedFrames
+			&& header.dataOffset >= tableSize && header.dataOffset <= size;
+	if(valid){
+		//width*height fits into 64 bit, bytes per sample is at most 4
+		quint64 samplesPerFrame = static_cast<quint64>(header.width)*header.height;
+		quint64 bytesPerSample = FrameHandle::bytesPerSample(header.bitDepth);
+		valid = samplesPerFrame <= std::numeric_limits<quint64>::max()/bytesPerSample
+				&& header.bytesPerFrame >= samplesPerFrame*bytesPerSample
+				&& header.bytesPerFrame <= size-header.dataOffset
+				&& (size-header.dataOffset)/header.bytesPerFrame >= header.capturedFrames;
+	}
+	if(!valid){
+		this->errorString = QCoreApplication::translate("RecordingFile", "Corrupted or truncated capture file: ") + this->file.fileName();
+		return false;
+	}
+	this->source = static_cast<BUFFER_SOURCE>(header.source);
+	this->bitDepth = header.bitDepth;
+	this->samplesPerLine = header.width;
+	this->linesPerFrame = header.height;
+	this->bytesPerFrame = static_cast<size_t>(header.bytesPerFrame);
+	this->frameData = this->mapping + header.dataOffset;
+	this->numberOfFrames = header.capturedFrames;
+	return true;
+}
@@ -0,0 +1,74 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#ifndef RECORDINGFILE_H
+#define RECORDINGFILE_H
+
+#include <QFile>
+#include <QString>
+#include "frameingest.h"
+
+//RecordingFile memory-maps a frame capture of the extension (dimensions are read from its header) or a plain
+//OCTproZ recording without header (dimensions have to be known). Frames can be read from any thread while the file is open.
+class RecordingFile
+{
+public:
+	RecordingFile();
+	~RecordingFile();
+
+	//bitDepth, samplesPerLine and linesPerFrame are only used if the file has no capture header
+	bool open(const QString& fileName, unsigned int bitDepth, unsigned int samplesPerLine, unsigned int linesPerFrame, BUFFER_SOURCE source);
+	void close();
+	QString getErrorString() const {return this->errorString;}
+
+	bool hasCaptureHeader() const {return this->captureHeader;}
+	BUFFER_SOURCE getSource() const {return this->source;}
+	unsigned int getBitDepth() const {return this->bitDepth;}
+	unsigned int getSamplesPerLine() const {return this->samplesPerLine;}
+	unsigned int getLinesPerFrame() const {return this->linesPerFrame;}
+	size_t getBytesPerFrame() const {return this->bytesPerFrame;}
+	quint64 getNumberOfFrames() const {return this->numberOfFrames;}
+	const void* getFrame(quint64 index) const {return this->frameData + index*this->bytesPerFrame;}
+
+private:
+	QFile file;
+	uchar* mapping;
+	const uchar* frameData;
+	QString errorString;
+	bool captureHeader;
+	BUFFER_SOURCE source;
+	unsigned int bitDepth;
+	unsigned int samplesPerLine;
+	unsigned int linesPerFrame;
+	size_t bytesPerFrame;
+	quint64 numberOfFrames;
+
+	bool readCaptureHeader(qint64 fileSize);
+};
+
+#endif // RECORDINGFILE_H
@@ -0,0 +1,133 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#ifndef SHAREDSTATISTICSLAYOUT_H
+#define SHAREDSTATISTICSLAYOUT_H
+
+//layout of the shared memory segments written by StatisticsSharedMemory. This header does not depend on Qt, so other
+//processes can include it to read the statistics. There is one segment per buffer source with a ring of slotCount slots.
+//Every slot is protected by a seqlock: the writer makes the sequence odd, writes the record and the histogram and makes the
+//sequence even again. A reader copies the slot and retries a limited number of times if the sequence was odd or changed
+//meanwhile. Reading a slot that is not being written needs no system call, and the reader never blocks the writer.
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+#define SHARED_STATISTICS_MAGIC 0x53534f49 //"IOSS" in little endian byte order
+#define SHARED_STATISTICS_VERSION 1
+#define SHARED_STATISTICS_ALIGNMENT 64
+#define SHARED_STATISTICS_READ_ATTEMPTS 64 //a slot that is still being written after this many attempts is given up, e.g. if the writer died
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2 && ATOMIC_LLONG_LOCK_FREE == 2, "shared memory layout needs lock free atomics");
+
+struct SharedStatisticsHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t source; //0 raw, 1 processed
+	uint32_t slotCount;
+	uint32_t maxHistogramBins;
+	uint32_t reserved;
+	uint64_t slotSize; //bytes per slot including histogram
+	uint64_t firstSlotOffset; //bytes from start of segment to first slot
+	alignas(SHARED_STATISTICS_ALIGNMENT) std::atomic<uint64_t> writeIndex; //number of written records, record i is stored in slot i%slotCount
+};
+
+struct SharedStatisticsRecord {
+	uint64_t index;
+	uint64_t sequenceNumber;
+	uint64_t frameSequenceNumber;
+	int64_t timestamp; //microseconds since epoch
+	double min;
+	double max;
+	double sum;
+	double average;
+	double stdDeviation;
+	double coeffOfVariation;
+	double percentile5;
+	double median;
+	double percentile95;
+	int32_t pixels;
+	int32_t roiX;
+	int32_t roiY;
+	int32_t roiWidth;
+	int32_t roiHeight;
+	uint32_t valuesPerBin;
+	uint32_t numberOfBins;
+	uint32_t reserved;
+};
+
+//histogram bins (uint32_t) follow the slot directly
+struct SharedStatisticsSlot {
+	std::atomic<uint32_t> sequence;
+	uint32_t reserved;
+	SharedStatisticsRecord record;
+};
+
+inline SharedStatisticsSlot* sharedStatisticsSlot(const SharedStatisticsHeader* header, uint64_t index) {
+	const char* base = reinterpret_cast<const char*>(header) + header->firstSlotOffset;
+	return reinterpret_cast<SharedStatisticsSlot*>(const_cast<char*>(base + (index%header->slotCount)*header->slotSize));
+}
+
+//copies record index into record and up to maxBins histogram bins into bins (bins can be null). returns false if the
+//record was not written yet, was already overwritten or could not be read consistently within SHARED_STATISTICS_READ_ATTEMPTS
+//attempts. the reader only yields its time slice while the slot is being written
+inline bool sharedStatisticsRead(const SharedStatisticsHeader* header, uint64_t index, SharedStatisticsRecord* record, uint32_t* bins, uint32_t maxBins) {
+	if(index >= header->writeIndex.load(std::memory_order_acquire)){
+		return false;
+	}
+	const SharedStatisticsSlot* slot = sharedStatisticsSlot(header, index);
+	const uint32_t* slotBins = reinterpret_cast<const uint32_t*>(slot + 1);
+	for(int attempt = 0; attempt < SHARED_STATISTICS_READ_ATTEMPTS; attempt++){
+		if(attempt > 0){
+			std::this_thread::yield();
+		}
+		uint32_t sequenceBefore = slot->sequence.load(std::memory_order_acquire);
+		if(sequenceBefore & 1){
+			continue;
+		}
+		memcpy(record, &slot->record, sizeof(SharedStatisticsRecord));
+		uint32_t numberOfBins = record->numberOfBins < maxBins ? record->numberOfBins : maxBins;
+		if(bins != nullptr && numberOfBins <= header->maxHistogramBins){
+			memcpy(bins, slotBins, numberOfBins*sizeof(uint32_t));
+		}
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if(slot->sequence.load(std::memory_order_relaxed) == sequenceBefore){
+			return record->index == index;
+		}
+	}
+	return false;
+}
+
+inline bool sharedStatisticsReadLatest(const SharedStatisticsHeader* header, SharedStatisticsRecord* record, uint32_t* bins, uint32_t maxBins) {
+	uint64_t writeIndex = header->writeIndex.load(std::memory_order_acquire);
+	return writeIndex > 0 && sharedStatisticsRead(header, writeIndex-1, record, bins, maxBins);
+}
+
+#endif // SHAREDSTATISTICSLAYOUT_H
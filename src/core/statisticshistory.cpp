@@ -0,0 +1,189 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#include "statisticshistory.h"
+#include <QMutexLocker>
+#include <limits>
+
+
+StatisticsHistory::StatisticsHistory(int capacity) {
+	//capacity is a multiple of the block size, so a block never spans the wrap around of the ring
+	this->capacity = qMax(1, (capacity + STATISTICS_HISTORY_BLOCK_SIZE - 1)/STATISTICS_HISTORY_BLOCK_SIZE)*STATISTICS_HISTORY_BLOCK_SIZE;
+	this->first = 0;
+	this->size = 0;
+	this->revision = 0;
+	this->clockOffset = 0;
+}
+
+StatisticsSample StatisticsHistory::sampleFromStatistics(qint64 timestamp, const ImageStatistics& statistics) {
+	StatisticsSample sample;
+	sample.timestamp = timestamp;
+	sample.values[HISTORY_MEAN] = static_cast<float>(statistics.average);
+	sample.values[HISTORY_STD_DEVIATION] = static_cast<float>(statistics.stdDeviation);
+	sample.values[HISTORY_MIN] = static_cast<float>(statistics.min);
+	sample.values[HISTORY_MAX] = static_cast<float>(statistics.max);
+	sample.values[HISTORY_PERCENTILE_5] = static_cast<float>(statistics.percentile5);
+	sample.values[HISTORY_MEDIAN] = static_cast<float>(statistics.median);
+	sample.values[HISTORY_PERCENTILE_95] = static_cast<float>(statistics.percentile95);
+	return sample;
+}
+
+void StatisticsHistory::append(const StatisticsSample& newSample) {
+	QMutexLocker locker(&this->mutex);
+
+	//memory is allocated with the first sample, so histories of unused sources do not take any memory
+	if(this->samples.isEmpty()){
+		this->samples.resize(this->capacity);
+		this->blocks.resize(this->capacity/STATISTICS_HISTORY_BLOCK_SIZE);
+	}
+
+	//timestamps must be increasing for the binary search in decimate(). timestamps are taken from the wall clock, if it is
+	//set back the step is added to clockOffset, so the following samples continue after the last one with correct spacing
+	StatisticsSample sample = newSample;
+	sample.timestamp += this->clockOffset;
+	if(this->size > 0 && sample.timestamp < this->at(this->size-1).timestamp){
+		this->clockOffset += this->at(this->size-1).timestamp - sample.timestamp;
+		sample.timestamp = this->at(this->size-1).timestamp;
+	}
+
+	int index;
+	if(this->size < this->capacity){
+		index = (this->first + this->size) % this->capacity;
+		this->size++;
+	}else{
+		index = this->first;
+		this->first = (this->first + 1) % this->capacity;
+	}
+	this->samples[index] = sample;
+	this->updateBlock(index);
+	this->revision++;
+}
+
+void StatisticsHistory::clear() {
+	QMutexLocker locker(&this->mutex);
+	this->first = 0;
+	this->size = 0;
+	this->clockOffset = 0;
+	this->revision++;
+}
+
+int StatisticsHistory::getSize() const {
+	QMutexLocker locker(&this->mutex);
+	return this->size;
+}
+
+quint64 StatisticsHistory::getRevision() const {
+	QMutexLocker locker(&this->mutex);
+	return this->revision;
+}
+
+bool StatisticsHistory::getTimeRange(qint64* firstTimestamp, qint64* lastTimestamp) const {
+	QMutexLocker locker(&this->mutex);
+	if(this->size == 0){
+		return false;
+	}
+	*firstTimestamp = this->at(0).timestamp;
+	*lastTimestamp = this->at(this->size-1).timestamp;
+	return true;
+}
+
+void StatisticsHistory::decimate(HISTORY_VALUE value, qint64 startTime, qint64 endTime, int columns, QVector<float>* minValues, QVector<float>* maxValues) const {
+	QMutexLocker locker(&this->mutex);
+	columns = qMax(1, columns);
+	minValues->resize(columns);
+	maxValues->resize(columns);
+	double columnDuration = static_cast<double>(endTime - startTime)/columns;
+
+	//each column covers the samples between two timestamps. empty columns are marked with NaN
+	int begin = this->lowerBound(startTime);
+	for(int column = 0; column < columns; column++){
+		qint64 columnEnd = startTime + static_cast<qint64>((column + 1)*columnDuration);
+		int end = column == columns-1 ? this->lowerBound(endTime + 1) : this->lowerBound(columnEnd);
+		if(end > begin){
+			this->rangeMinMax(value, begin, end, &(*minValues)[column], &(*maxValues)[column]);
+		}else{
+			(*minValues)[column] = std::numeric_limits<float>::quiet_NaN();
+			(*maxValues)[column] = std::numeric_limits<float>::quiet_NaN();
+		}
+		begin = end;
+	}
+}
+
+const StatisticsSample& StatisticsHistory::at(int index) const {
+	return this->samples[(this->first + index) % this->capacity];
+}
+
+int StatisticsHistory::lowerBound(qint64 timestamp) const {
+	//first logical index with a timestamp that is not less than timestamp
+	int low = 0;
+	int high = this->size;
+	while(low < high){
+		int middle = low + (high - low)/2;
+		if(this->at(middle).timestamp < timestamp){
+			low = middle + 1;
+		}else{
+			high = middle;
+		}
+	}
+	return low;
+}
+
+void StatisticsHistory::rangeMinMax(HISTORY_VALUE value, int begin, int end, float* min, float* max) const {
+	//samples at the borders are visited directly, complete blocks in between only by their summary
+	float rangeMin = std::numeric_limits<float>::max();
+	float rangeMax = std::numeric_limits<float>::lowest();
+	int index = begin;
+	while(index < end){
+		int ringIndex = (this->first + index) % this->capacity;
+		if(ringIndex % STATISTICS_HISTORY_BLOCK_SIZE == 0 && index + STATISTICS_HISTORY_BLOCK_SIZE <= end){
+			const Block& block = this->blocks[ringIndex/STATISTICS_HISTORY_BLOCK_SIZE];
+			rangeMin = qMin(rangeMin, block.min[value]);
+			rangeMax = qMax(rangeMax, block.max[value]);
+			index += STATISTICS_HISTORY_BLOCK_SIZE;
+		}else{
+			float sampleValue = this->samples[ringIndex].values[value];
+			rangeMin = qMin(rangeMin, sampleValue);
+			rangeMax = qMax(rangeMax, sampleValue);
+			index++;
+		}
+	}
+	*min = rangeMin;
+	*max = rangeMax;
+}
+
+void StatisticsHistory::updateBlock(int ringIndex) {
+	//blocks are written from their first sample on, so the summary is reset with the first sample of a block. a block summary
+	//is only used if all of its samples are part of the history, so samples of the previous pass through the ring do not matter
+	Block& summary = this->blocks[ringIndex/STATISTICS_HISTORY_BLOCK_SIZE];
+	const StatisticsSample& sample = this->samples[ringIndex];
+	bool firstSampleOfBlock = ringIndex % STATISTICS_HISTORY_BLOCK_SIZE == 0;
+	for(int value = 0; value < HISTORY_VALUE_COUNT; value++){
+		summary.min[value] = firstSampleOfBlock ? sample.values[value] : qMin(summary.min[value], sample.values[value]);
+		summary.max[value] = firstSampleOfBlock ? sample.values[value] : qMax(summary.max[value], sample.values[value]);
+	}
+}
@@ -0,0 +1,93 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#ifndef STATISTICSHISTORY_H
+#define STATISTICSHISTORY_H
+
+#define STATISTICS_HISTORY_CAPACITY 1048576 //number of samples kept per source
+#define STATISTICS_HISTORY_BLOCK_SIZE 256 //number of samples that are summarized by one min/max block
+
+#include <QMutex>
+#include <QVector>
+#include "statisticssnapshot.h"
+
+enum HISTORY_VALUE {
+	HISTORY_MEAN,
+	HISTORY_STD_DEVIATION,
+	HISTORY_MIN,
+	HISTORY_MAX,
+	HISTORY_PERCENTILE_5,
+	HISTORY_MEDIAN,
+	HISTORY_PERCENTILE_95,
+	HISTORY_VALUE_COUNT
+};
+
+struct StatisticsSample {
+	qint64 timestamp; //microseconds since epoch
+	float values[HISTORY_VALUE_COUNT];
+};
+
+//StatisticsHistory is a fixed capacity ring buffer of per frame statistics. Every block of STATISTICS_HISTORY_BLOCK_SIZE samples
+//has a min/max summary, so the history can be decimated to a few pixel columns without visiting every sample.
+//append() is called by the calculator thread, all methods are thread safe.
+class StatisticsHistory
+{
+public:
+	explicit StatisticsHistory(int capacity = STATISTICS_HISTORY_CAPACITY);
+
+	static StatisticsSample sampleFromStatistics(qint64 timestamp, const ImageStatistics& statistics);
+
+	void append(const StatisticsSample& newSample);
+	void clear();
+	int getSize() const;
+	quint64 getRevision() const;
+	bool getTimeRange(qint64* firstTimestamp, qint64* lastTimestamp) const;
+	void decimate(HISTORY_VALUE value, qint64 startTime, qint64 endTime, int columns, QVector<float>* minValues, QVector<float>* maxValues) const;
+
+private:
+	struct Block {
+		float min[HISTORY_VALUE_COUNT];
+		float max[HISTORY_VALUE_COUNT];
+	};
+
+	const StatisticsSample& at(int index) const;
+	int lowerBound(qint64 timestamp) const;
+	void rangeMinMax(HISTORY_VALUE value, int begin, int end, float* min, float* max) const;
+	void updateBlock(int ringIndex);
+
+	QVector<StatisticsSample> samples;
+	QVector<Block> blocks;
+	int capacity;
+	int first; //ring index of the oldest sample
+	int size;
+	quint64 revision;
+	qint64 clockOffset; //added to all timestamps, grows when the wall clock is set back
+	mutable QMutex mutex;
+};
+
+#endif // STATISTICSHISTORY_H
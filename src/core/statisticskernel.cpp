@@ -0,0 +1,170 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#include "statisticskernel.h"
+#include <QtMath>
+
+
+int StatisticsKernel::numberOfBins(unsigned int bitDepth) {
+	return static_cast<int>(pow(2, bitDepth));
+}
+
+void StatisticsKernel::percentilesFromHistogram(const quint32* bins, int numberOfBins, quint64 pixels, ImageStatistics* statistics) {
+	//percentiles from cumulative histogram
+	qreal percentiles[3] = {0.05, 0.5, 0.95};
+	qreal* results[3] = {&statistics->percentile5, &statistics->median, &statistics->percentile95};
+	quint64 cumulativeCount = 0;
+	int percentileIndex = 0;
+	for(int i = 0; i < numberOfBins && percentileIndex < 3; i++){
+		cumulativeCount += bins[i];
+		while(percentileIndex < 3 && cumulativeCount >= percentiles[percentileIndex]*pixels){
+			*results[percentileIndex] = i;
+			percentileIndex++;
+		}
+	}
+}
+
+int StatisticsKernel::downsampledBins(int numberOfBins, int maxOutputBins, int* valuesPerBin) {
+	if(maxOutputBins <= 0 || numberOfBins <= 0){
+		*valuesPerBin = 1;
+		return 0;
+	}
+	*valuesPerBin = (numberOfBins+maxOutputBins-1)/maxOutputBins;
+	return (numberOfBins+*valuesPerBin-1)/(*valuesPerBin);
+}
+
+void StatisticsKernel::downsampleHistogram(const quint32* bins, int numberOfBins, int valuesPerBin, int outputBins, quint32* output) {
+	for(int i = 0; i < outputBins; i++){
+		quint32 sum = 0;
+		int last = qMin(numberOfBins, (i+1)*valuesPerBin);
+		for(int j = i*valuesPerBin; j < last; j++){
+			sum += bins[j];
+		}
+		output[i] = sum;
+	}
+}
+
+bool StatisticsKernel::calculate(const void* samples, unsigned int bitDepth, size_t stride, const QRect& region, const uchar* mask, size_t maskStride, ImageStatistics* statistics, QVector<quint32>* histogram) {
+	//set buffer datatype according bitdepth
+	//uchar
+	if(bitDepth <= 8){
+		return dispatch(static_cast<const unsigned char*>(samples), bitDepth, stride, region, mask, maskStride, statistics, histogram);
+	}
+	//ushort
+	else if(bitDepth > 8 && bitDepth <= 16){
+		return dispatch(static_cast<const unsigned short*>(samples), bitDepth, stride, region, mask, maskStride, statistics, histogram);
+	}
+	//unsigned int (32 bit)
+	else if(bitDepth > 16 && bitDepth <= 32){
+		return dispatch(static_cast<const unsigned int*>(samples), bitDepth, stride, region, mask, maskStride, statistics, histogram);
+	}
+	return false;
+}
+
+template<typename T>
+bool StatisticsKernel::dispatch(const T* samples, unsigned int bitDepth, size_t stride, const QRect& region, const uchar* mask, size_t maskStride, ImageStatistics* statistics, QVector<quint32>* histogram) {
+	//the mask test is a template parameter, so the loops without mask stay as tight as before
+	if(mask != nullptr){
+		return calculateTyped<T, true>(samples, bitDepth, stride, region, mask, maskStride, statistics, histogram);
+	}
+	return calculateTyped<T, false>(samples, bitDepth, stride, region, mask, maskStride, statistics, histogram);
+}
+
+template<typename T, bool masked>
+qreal StatisticsKernel::standardDeviation(const T* samples, size_t stride, const QRect& region, const uchar* mask, size_t maskStride, qreal mean, int pixels) {
+	qreal sum = 0;
+	for(int y = region.top(); y <= region.bottom(); y++){
+		const T* line = samples + static_cast<size_t>(y)*stride;
+		const uchar* maskLine = masked ? mask + static_cast<size_t>(y)*maskStride : nullptr;
+		for(int x = region.left(); x <= region.right(); x++){
+			if(masked && maskLine[x] == 0){
+				continue;
+			}
+			qreal deviation = line[x] - mean;
+			sum = sum + deviation*deviation;
+		}
+	}
+	return qSqrt(sum/pixels);
+}
+
+template<typename T, bool masked>
+bool StatisticsKernel::calculateTyped(const T* samples, unsigned int bitDepth, size_t stride, const QRect& region, const uchar* mask, size_t maskStride, ImageStatistics* statistics, QVector<quint32>* histogram) {
+	//one histogram bin for every possible value, bin i counts samples with value i
+	int numberOfPossibleValues = numberOfBins(bitDepth);
+	if(histogram->size() != numberOfPossibleValues){
+		histogram->resize(numberOfPossibleValues);
+	}
+	histogram->fill(0);
+	quint32* bins = histogram->data();
+
+	//init params for statistic calculation
+	qreal sum = 0;
+	qreal maxValue = 0;
+	qreal minValue = 999999999;
+	int pixels = 0;
+
+	//statistics calculation. region is the roi in coordinates of the stored samples, each stored line has stride samples
+	for(int y = region.top(); y <= region.bottom(); y++){
+		const T* line = samples + static_cast<size_t>(y)*stride;
+		const uchar* maskLine = masked ? mask + static_cast<size_t>(y)*maskStride : nullptr;
+		for(int x = region.left(); x <= region.right(); x++){
+			if(masked && maskLine[x] == 0){
+				continue;
+			}
+			qreal currValue = line[x];
+			if(maxValue < currValue){maxValue = currValue;}
+			if(minValue > currValue){minValue = currValue;}
+			pixels++;
+			sum += currValue;
+
+			if(currValue>(numberOfPossibleValues-1)){
+				currValue = numberOfPossibleValues-1;
+			}
+			if(currValue<0){
+				currValue = 0;
+			}
+			bins[static_cast<int>(currValue)]++;
+		}
+	}
+	if(pixels == 0){
+		return false;
+	}
+
+	//update ImageStatistics struct
+	ImageStatistics& stats = *statistics;
+	stats.max = maxValue;
+	stats.min = minValue;
+	stats.pixels = pixels;
+	stats.sum = sum;
+	stats.average = stats.sum/pixels;
+	stats.stdDeviation = standardDeviation<T, masked>(samples, stride, region, mask, maskStride, stats.average, pixels);
+	stats.coeffOfVariation = stats.stdDeviation/stats.average;
+
+	percentilesFromHistogram(bins, numberOfPossibleValues, static_cast<quint64>(pixels), statistics);
+	return true;
+}
@@ -0,0 +1,60 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#ifndef STATISTICSKERNEL_H
+#define STATISTICSKERNEL_H
+
+#include <QRect>
+#include <QVector>
+#include "statisticssnapshot.h"
+
+//StatisticsKernel calculates the statistics and the histogram of a region of a frame. It has no state, so it can be
+//called from any number of threads at the same time as long as every call writes to its own results.
+class StatisticsKernel
+{
+public:
+	//samples: first stored line of the frame, stride: samples per stored line, region: evaluated samples in stored coordinates.
+	//mask (optional): one byte per sample with maskStride bytes per line in the same coordinates, samples with mask value 0 are skipped.
+	//the histogram is only reallocated if its size does not match the bit depth. returns false if no sample was evaluated.
+	static bool calculate(const void* samples, unsigned int bitDepth, size_t stride, const QRect& region, const uchar* mask, size_t maskStride, ImageStatistics* statistics, QVector<quint32>* histogram);
+	static int numberOfBins(unsigned int bitDepth);
+
+	//sets 5th percentile, median and 95th percentile from a histogram that counts pixels samples
+	static void percentilesFromHistogram(const quint32* bins, int numberOfBins, quint64 pixels, ImageStatistics* statistics);
+
+	//histograms are downsampled for export by summing valuesPerBin neighboring bins. returns the number of output bins (at most maxOutputBins)
+	static int downsampledBins(int numberOfBins, int maxOutputBins, int* valuesPerBin);
+	static void downsampleHistogram(const quint32* bins, int numberOfBins, int valuesPerBin, int outputBins, quint32* output);
+
+private:
+	template <typename T, bool masked> static bool calculateTyped(const T* samples, unsigned int bitDepth, size_t stride, const QRect& region, const uchar* mask, size_t maskStride, ImageStatistics* statistics, QVector<quint32>* histogram);
+	template <typename T, bool masked> static qreal standardDeviation(const T* samples, size_t stride, const QRect& region, const uchar* mask, size_t maskStride, qreal mean, int pixels);
+	template <typename T> static bool dispatch(const T* samples, unsigned int bitDepth, size_t stride, const QRect& region, const uchar* mask, size_t maskStride, ImageStatistics* statistics, QVector<quint32>* histogram);
+};
+
+#endif // STATISTICSKERNEL_H
@@ -0,0 +1,110 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#include "statisticsmetrics.h"
+#include <QtAlgorithms>
+
+
+LatencyHistogram::LatencyHistogram()
+{
+	for(QAtomicInteger<quint64>& bucket : this->buckets){
+		bucket.storeRelaxed(0);
+	}
+	this->count.storeRelaxed(0);
+	this->sum.storeRelaxed(0);
+}
+
+void LatencyHistogram::add(qint64 microseconds) {
+	//latencies across a clock adjustment can be negative
+	quint64 value = static_cast<quint64>(qMax(Q_INT64_C(0), microseconds));
+	QAtomicInteger<quint64>& bucket = this->buckets[bucketIndex(value)];
+	bucket.storeRelaxed(bucket.loadRelaxed()+1);
+	this->sum.storeRelaxed(this->sum.loadRelaxed()+value);
+	this->count.storeRelease(this->count.loadRelaxed()+1);
+}
+
+double LatencyHistogram::quantile(double q) const {
+	//buckets are read one by one while the writer continues, the total is taken from the copied buckets so the result is consistent
+	quint64 counts[METRICS_LATENCY_BUCKETS];
+	quint64 total = 0;
+	for(int i = 0; i < METRICS_LATENCY_BUCKETS; i++){
+		counts[i] = this->buckets[i].loadRelaxed();
+		total += counts[i];
+	}
+	if(total == 0){
+		return 0.0;
+	}
+	double rank = qBound(0.0, q, 1.0)*static_cast<double>(total);
+	quint64 below = 0;
+	for(int i = 0; i < METRICS_LATENCY_BUCKETS; i++){
+		if(counts[i] > 0 && static_cast<double>(below+counts[i]) >= rank){
+			double lower = static_cast<double>(bucketLowerBound(i));
+			double upper = static_cast<double>(bucketLowerBound(i+1));
+			return lower + (upper-lower)*(rank-static_cast<double>(below))/static_cast<double>(counts[i]);
+		}
+		below += counts[i];
+	}
+	return static_cast<double>(bucketLowerBound(METRICS_LATENCY_BUCKETS));
+}
+
+int LatencyHistogram::bucketIndex(quint64 microseconds) {
+	//values below 4 have their own bucket, above that every power of two is split into quarters
+	if(microseconds < 4){
+		return static_cast<int>(microseconds);
+	}
+	int exponent = 63-static_cast<int>(qCountLeadingZeroBits(microseconds));
+	int index = (exponent-1)*4 + static_cast<int>((microseconds >> (exponent-2)) & 3);
+	return qMin(index, METRICS_LATENCY_BUCKETS-1);
+}
+
+quint64 LatencyHistogram::bucketLowerBound(int index) {
+	if(index < 4){
+		return static_cast<quint64>(index);
+	}
+	int exponent = index/4+1;
+	return static_cast<quint64>(4+index%4) << (exponent-2);
+}
+
+
+StatisticsMetrics::StatisticsMetrics()
+{
+	this->receivedFrames.storeRelaxed(0);
+	this->lostFrames.storeRelaxed(0);
+	this->processedFrames.storeRelaxed(0);
+	this->droppedFrames.storeRelaxed(0);
+}
+
+const char* StatisticsMetrics::stageName(METRICS_STAGE stage) {
+	switch(stage){
+		case INGEST_STAGE: return "ingest";
+		case QUEUE_STAGE: return "queue";
+		case CALCULATION_STAGE: return "calculation";
+		case END_TO_END_STAGE: return "end_to_end";
+		default: return "unknown";
+	}
+}
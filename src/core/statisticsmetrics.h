@@ -0,0 +1,105 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#ifndef STATISTICSMETRICS_H
+#define STATISTICSMETRICS_H
+
+#define METRICS_LATENCY_BUCKETS 124 //latencies in microseconds, 4 buckets per power of two up to 2^32 us
+
+#include <QtGlobal>
+#include <QAtomicInteger>
+
+enum METRICS_STAGE{
+	INGEST_STAGE, //data callback: frame selection and copies
+	QUEUE_STAGE, //frame copy waiting for the calculator thread
+	CALCULATION_STAGE, //statistics and histogram of the roi
+	END_TO_END_STAGE, //frame received until all statistics sinks are done
+	METRICS_STAGES
+};
+
+//LatencyHistogram counts latencies in logarithmic buckets. add() must only be called by one thread, so counters are
+//updated without locked instructions. Any thread can read the histogram at any time.
+class LatencyHistogram
+{
+public:
+	LatencyHistogram();
+
+	void add(qint64 microseconds);
+	quint64 getCount() const {return this->count.loadAcquire();}
+	quint64 getSumMicroseconds() const {return this->sum.loadRelaxed();}
+	double quantile(double q) const; //microseconds, interpolated within the bucket
+
+	static int bucketIndex(quint64 microseconds);
+	static quint64 bucketLowerBound(int index);
+
+private:
+	QAtomicInteger<quint64> buckets[METRICS_LATENCY_BUCKETS];
+	QAtomicInteger<quint64> count;
+	QAtomicInteger<quint64> sum;
+};
+
+//StatisticsMetrics holds the pre-aggregated counters of one buffer source. The frame ingest (data callback thread) and
+//the statistics calculator (calculator thread) of the source each update their own counters, a metrics endpoint only
+//reads them and never waits for or interrupts frame processing.
+class StatisticsMetrics
+{
+public:
+	StatisticsMetrics();
+
+	//frame ingest
+	void addReceivedFrame(){increment(&this->receivedFrames);}
+	void addLostFrame(){increment(&this->lostFrames);}
+
+	//statistics calculator
+	void addProcessedFrame(){increment(&this->processedFrames);}
+	void addDroppedFrame(){increment(&this->droppedFrames);}
+
+	void addLatency(METRICS_STAGE stage, qint64 microseconds){this->latencies[stage].add(microseconds);}
+
+	quint64 getReceivedFrames() const {return this->receivedFrames.loadRelaxed();}
+	quint64 getLostFrames() const {return this->lostFrames.loadRelaxed();}
+	quint64 getProcessedFrames() const {return this->processedFrames.loadRelaxed();}
+	quint64 getDroppedFrames() const {return this->droppedFrames.loadRelaxed();}
+	const LatencyHistogram& getLatency(METRICS_STAGE stage) const {return this->latencies[stage];}
+
+	static const char* stageName(METRICS_STAGE stage);
+
+private:
+	Q_DISABLE_COPY(StatisticsMetrics)
+
+	//every counter has a single writer, so a relaxed load and store is enough
+	static void increment(QAtomicInteger<quint64>* counter){counter->storeRelaxed(counter->loadRelaxed()+1);}
+
+	QAtomicInteger<quint64> receivedFrames;
+	QAtomicInteger<quint64> lostFrames; //buffers that arrived while the previous one was still ingested or grabbing was not allowed
+	QAtomicInteger<quint64> processedFrames;
+	QAtomicInteger<quint64> droppedFrames; //frame copies that arrived while the calculator was busy
+	LatencyHistogram latencies[METRICS_STAGES];
+};
+
+#endif // STATISTICSMETRICS_H
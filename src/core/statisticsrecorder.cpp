@@ -0,0 +1,249 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#include "statisticsrecorder.h"
+#include <QDataStream>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <cstdio>
+
+
+StatisticsRecorder::StatisticsRecorder(QObject* parent) : QObject(parent)
+{
+	this->format = RECORDING_CSV;
+	this->recording.storeRelaxed(0);
+	this->recordHistograms.storeRelaxed(0);
+	this->droppedRecords.storeRelaxed(0);
+	this->writtenRecords = 0;
+	this->flushTimer = nullptr;
+}
+
+StatisticsRecorder::~StatisticsRecorder()
+{
+	this->slot_stop();
+}
+
+void StatisticsRecorder::record(BUFFER_SOURCE source, const StatisticsSnapshotData* snapshot) {
+	if(!this->isRecording()){
+		return;
+	}
+	int numberOfBins = this->recordHistograms.loadAcquire() != 0 ? snapshot->histogram.size() : 0;
+
+	//queue memory is reserved when recording starts, appending does not allocate. recording is checked again under the
+	//lock, because slot_stop releases the queues after it cleared the flag
+	QMutexLocker locker(&this->queueMutex);
+	if(!this->isRecording()){
+		return;
+	}
+	if(this->queuedRecords.size() >= RECORDER_QUEUE_CAPACITY || this->queuedBins.size() + numberOfBins > RECORDER_BIN_CAPACITY){
+		this->droppedRecords.fetchAndAddRelaxed(1);
+		return;
+	}
+	Record record;
+	record.source = source;
+	record.sequenceNumber = snapshot->sequenceNumber;
+	record.frameSequenceNumber = snapshot->frameSequenceNumber;
+	record.timestamp = snapshot->timestamp;
+	record.statistics = snapshot->statistics;
+	record.firstBin = this->queuedBins.size();
+	record.numberOfBins = numberOfBins;
+	this->queuedRecords.append(record);
+	if(numberOfBins > 0){
+		this->queuedBins.append(snapshot->histogram);
+	}
+}
+
+bool StatisticsRecorder::hasSpaceFor(int numberOfBins) {
+	//offline tools flush when this returns false instead of dropping records
+	QMutexLocker locker(&this->queueMutex);
+	int bins = this->recordHistograms.loadAcquire() != 0 ? numberOfBins : 0;
+	return this->queuedRecords.size() < RECORDER_QUEUE_CAPACITY && this->queuedBins.size() + bins <= RECORDER_BIN_CAPACITY;
+}
+
+void StatisticsRecorder::slot_start(QString fileName, bool includeHistograms) {
+	this->slot_stop();
+
+	//"-" writes csv to standard output, this is used by command line tools
+	bool standardOutput = fileName == "-";
+	bool opened = false;
+	if(standardOutput){
+		opened = this->file.open(stdout, QIODevice::WriteOnly);
+	}else{
+		this->file.setFileName(fileName);
+		opened = this->file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+	}
+	if(!opened){
+		emit error(tr("Recorder: Could not open ") + fileName);
+		return;
+	}
+	this->format = standardOutput || QFileInfo(fileName).suffix().toLower() == "csv" ? RECORDING_CSV : RECORDING_BINARY;
+
+	//reserve queues for the maximum number of records, so producers never allocate
+	{
+		QMutexLocker locker(&this->queueMutex);
+		this->queuedRecords.reserve(RECORDER_QUEUE_CAPACITY);
+		if(includeHistograms){
+			this->queuedBins.reserve(RECORDER_BIN_CAPACITY);
+		}
+	}
+	this->writeRecords.reserve(RECORDER_QUEUE_CAPACITY);
+	if(includeHistograms){
+		this->writeBins.reserve(RECORDER_BIN_CAPACITY);
+	}
+
+	//file header
+	this->writeBuffer.clear();
+	if(this->format == RECORDING_CSV){
+		this->writeBuffer.append("source,sequence_nr,frame_nr,timestamp_us,pixels,min,max,sum,average,std_deviation,coeff_of_variation,percentile_5,median,percentile_95,roi_x,roi_y,roi_width,roi_height");
+		this->writeBuffer.append(includeHistograms ? ",histogram\n" : "\n");
+	}else{
+		QDataStream stream(&this->writeBuffer, QIODevice::WriteOnly);
+		stream.setByteOrder(QDataStream::LittleEndian);
+		stream << static_cast<quint32>(RECORDER_BINARY_MAGIC) << static_cast<quint32>(RECORDER_BINARY_VERSION) << static_cast<quint32>(includeHistograms ? 1 : 0);
+	}
+	this->file.write(this->writeBuffer);
+
+	if(this->flushTimer == nullptr){
+		//timer is created here, so it lives in the thread of the recorder
+		this->flushTimer = new QTimer(this);
+		this->flushTimer->setInterval(RECORDER_FLUSH_INTERVAL_MS);
+		connect(this->flushTimer, &QTimer::timeout, this, &StatisticsRecorder::slot_flush);
+	}
+	this->flushTimer->start();
+
+	this->droppedRecords.storeRelaxed(0);
+	this->writtenRecords = 0;
+	this->recordHistograms.storeRelease(includeHistograms ? 1 : 0);
+	this->recording.storeRelease(1);
+	emit info(tr("Recorder: Recording statistics to ") + fileName);
+	emit recordingChanged(true);
+}
+
+void StatisticsRecorder::slot_stop() {
+	if(!this->isRecording()){
+		return;
+	}
+	this->recording.storeRelease(0);
+	this->flushTimer->stop();
+	this->slot_flush();
+	this->file.close();
+
+	//release queue memory. a producer that saw the recording flag before it was cleared may still hold the lock
+	{
+		QMutexLocker locker(&this->queueMutex);
+		this->queuedRecords = QVector<Record>();
+		this->queuedBins = QVector<quint32>();
+	}
+	this->writeRecords = QVector<Record>();
+	this->writeBins = QVector<quint32>();
+	this->writeBuffer = QByteArray();
+
+	emit info(tr("Recorder: Recording stopped. Written records: ") + QString::number(this->writtenRecords) + tr(", dropped records: ") + QString::number(this->getDroppedRecords()));
+	emit recordingChanged(false);
+}
+
+void StatisticsRecorder::slot_flush() {
+	if(!this->file.isOpen()){
+		return;
+	}
+	this->swapQueues();
+	if(this->writeRecords.isEmpty()){
+		return;
+	}
+	this->writeBuffer.clear();
+	if(this->format == RECORDING_CSV){
+		this->writeCsv();
+	}else{
+		this->writeBinary();
+	}
+	if(this->file.write(this->writeBuffer) != this->writeBuffer.size()){
+		emit error(tr("Recorder: Could not write to ") + this->file.fileName());
+	}
+	this->writtenRecords += this->writeRecords.size();
+}
+
+void StatisticsRecorder::swapQueues() {
+	//write queues are empty and have the same capacity as the queues of the producers, so swapping does not allocate
+	this->writeRecords.clear();
+	this->writeBins.clear();
+	QMutexLocker locker(&this->queueMutex);
+	this->queuedRecords.swap(this->writeRecords);
+	this->queuedBins.swap(this->writeBins);
+}
+
+void StatisticsRecorder::writeCsv() {
+	for(const Record& record : qAsConst(this->writeRecords)){
+		const ImageStatistics& s = record.statistics;
+		this->writeBuffer.append(record.source == RAW ? "raw," : "processed,");
+		this->writeBuffer.append(QByteArray::number(record.sequenceNumber)).append(',');
+		this->writeBuffer.append(QByteArray::number(record.frameSequenceNumber)).append(',');
+		this->writeBuffer.append(QByteArray::number(record.timestamp)).append(',');
+		this->writeBuffer.append(QByteArray::number(s.pixels)).append(',');
+		this->writeBuffer.append(QByteArray::number(s.min, 'g', 10)).append(',');
+		this->writeBuffer.append(QByteArray::number(s.max, 'g', 10)).append(',');
+		this->writeBuffer.append(QByteArray::number(s.sum, 'g', 15)).append(',');
+		this->writeBuffer.append(QByteArray::number(s.average, 'g', 10)).append(',');
+		this->writeBuffer.append(QByteArray::number(s.stdDeviation, 'g', 10)).append(',');
+		this->writeBuffer.append(QByteArray::number(s.coeffOfVariation, 'g', 10)).append(',');
+		this->writeBuffer.append(QByteArray::number(s.percentile5, 'g', 10)).append(',');
+		this->writeBuffer.append(QByteArray::number(s.median, 'g', 10)).append(',');
+		this->writeBuffer.append(QByteArray::number(s.percentile95, 'g', 10)).append(',');
+		this->writeBuffer.append(QByteArray::number(s.roiX)).append(',');
+		this->writeBuffer.append(QByteArray::number(s.roiY)).append(',');
+		this->writeBuffer.append(QByteArray::number(s.roiWidth)).append(',');
+		this->writeBuffer.append(QByteArray::number(s.roiHeight));
+		if(this->recordHistograms.loadRelaxed() != 0){
+			//histogram is one field with space separated bin counts
+			this->writeBuffer.append(',');
+			for(int i = 0; i < record.numberOfBins; i++){
+				if(i > 0){
+					this->writeBuffer.append(' ');
+				}
+				this->writeBuffer.append(QByteArray::number(this->writeBins[record.firstBin+i]));
+			}
+		}
+		this->writeBuffer.append('\n');
+	}
+}
+
+void StatisticsRecorder::writeBinary() {
+	//fixed size record followed by numberOfBins bin counts, all values little endian
+	QDataStream stream(&this->writeBuffer, QIODevice::WriteOnly);
+	stream.setByteOrder(QDataStream::LittleEndian);
+	stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+	for(const Record& record : qAsConst(this->writeRecords)){
+		const ImageStatistics& s = record.statistics;
+		stream << static_cast<quint8>(record.source) << record.sequenceNumber << record.frameSequenceNumber << record.timestamp;
+		stream << static_cast<qint32>(s.pixels) << s.min << s.max << s.sum << s.average << s.stdDeviation << s.coeffOfVariation << s.percentile5 << s.median << s.percentile95;
+		stream << static_cast<qint32>(s.roiX) << static_cast<qint32>(s.roiY) << static_cast<qint32>(s.roiWidth) << static_cast<qint32>(s.roiHeight);
+		stream << static_cast<quint32>(record.numberOfBins);
+		for(int i = 0; i < record.numberOfBins; i++){
+			stream << this->writeBins[record.firstBin+i];
+		}
+	}
+}
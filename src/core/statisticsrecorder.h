@@ -0,0 +1,108 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#ifndef STATISTICSRECORDER_H
+#define STATISTICSRECORDER_H
+
+#define RECORDER_QUEUE_CAPACITY 16384 //maximum number of records waiting for the writer thread
+#define RECORDER_BIN_CAPACITY 16777216 //maximum number of histogram bins waiting for the writer thread
+#define RECORDER_FLUSH_INTERVAL_MS 200
+#define RECORDER_BINARY_MAGIC 0x5253494f //"OISR" in little endian byte order
+#define RECORDER_BINARY_VERSION 1
+
+#include <QObject>
+#include <QFile>
+#include <QMutex>
+#include <QTimer>
+#include <QVector>
+#include <QAtomicInteger>
+#include "frameingest.h"
+#include "statisticssink.h"
+
+enum RECORDING_FORMAT {
+	RECORDING_CSV,
+	RECORDING_BINARY
+};
+
+//StatisticsRecorder writes every statistics result (and optionally every histogram) to disk. Calculator threads only append
+//records to a bounded queue, the queue is swapped out and written by the thread of the recorder with one large write per flush.
+//Records are dropped and counted if the queue is full, so calculator threads never wait for disk I/O.
+class StatisticsRecorder : public QObject, public StatisticsSink
+{
+	Q_OBJECT
+public:
+	explicit StatisticsRecorder(QObject* parent = nullptr);
+	~StatisticsRecorder();
+
+	void record(BUFFER_SOURCE source, const StatisticsSnapshotData* snapshot) override;
+	bool isRecording() const {return this->recording.loadAcquire() != 0;}
+	quint64 getDroppedRecords() const {return this->droppedRecords.loadAcquire();}
+	bool hasSpaceFor(int numberOfBins);
+
+private:
+	struct Record {
+		BUFFER_SOURCE source;
+		quint64 sequenceNumber;
+		quint64 frameSequenceNumber;
+		qint64 timestamp;
+		ImageStatistics statistics;
+		int firstBin; //index into queued bins
+		int numberOfBins;
+	};
+
+	void swapQueues();
+	void writeCsv();
+	void writeBinary();
+
+	QMutex queueMutex;
+	QVector<Record> queuedRecords;
+	QVector<quint32> queuedBins;
+	QVector<Record> writeRecords; //only used by recorder thread
+	QVector<quint32> writeBins;
+	QByteArray writeBuffer;
+
+	QFile file;
+	RECORDING_FORMAT format;
+	QAtomicInt recording;
+	QAtomicInt recordHistograms;
+	QAtomicInteger<quint64> droppedRecords;
+	quint64 writtenRecords;
+	QTimer* flushTimer;
+
+signals:
+	void info(QString);
+	void error(QString);
+	void recordingChanged(bool recording);
+
+public slots:
+	void slot_start(QString fileName, bool includeHistograms);
+	void slot_stop();
+	void slot_flush();
+};
+
+#endif // STATISTICSRECORDER_H
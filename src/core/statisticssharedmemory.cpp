@@ -0,0 +1,205 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#include "statisticssharedmemory.h"
+#include "statisticskernel.h"
+#include <QThread>
+#include <new>
+
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+
+StatisticsSharedMemory::StatisticsSharedMemory(QObject* parent) : QObject(parent)
+{
+	for(Segment& segment : this->segments){
+		segment.header = nullptr;
+		segment.size = 0;
+		segment.writeIndex = 0;
+#ifndef Q_OS_UNIX
+		segment.sharedMemory = nullptr;
+#endif
+	}
+	this->exporting.storeRelaxed(0);
+	this->writersInside.storeRelaxed(0);
+}
+
+StatisticsSharedMemory::~StatisticsSharedMemory()
+{
+	this->slot_stop();
+}
+
+void StatisticsSharedMemory::record(BUFFER_SOURCE source, const StatisticsSnapshotData* snapshot) {
+	//called by the calculator thread of the source, so every segment has a single writer. segments are only unmapped after writersInside dropped to zero
+	this->writersInside.ref();
+	if(this->exporting.loadAcquire() == 0 || source > PROCESSED){
+		this->writersInside.deref();
+		return;
+	}
+	Segment& segment = this->segments[source];
+	SharedStatisticsHeader* header = segment.header;
+	quint64 index = segment.writeIndex;
+	SharedStatisticsSlot* slot = sharedStatisticsSlot(header, index);
+
+	//sequence is odd while the slot is written
+	quint32 sequence = slot->sequence.load(std::memory_order_relaxed);
+	slot->sequence.store(sequence+1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	const ImageStatistics& s = snapshot->statistics;
+	SharedStatisticsRecord& record = slot->record;
+	record.index = index;
+	record.sequenceNumber = snapshot->sequenceNumber;
+	record.frameSequenceNumber = snapshot->frameSequenceNumber;
+	record.timestamp = snapshot->timestamp;
+	record.min = s.min;
+	record.max = s.max;
+	record.sum = s.sum;
+	record.average = s.average;
+	record.stdDeviation = s.stdDeviation;
+	record.coeffOfVariation = s.coeffOfVariation;
+	record.percentile5 = s.percentile5;
+	record.median = s.median;
+	record.percentile95 = s.percentile95;
+	record.pixels = s.pixels;
+	record.roiX = s.roiX;
+	record.roiY = s.roiY;
+	record.roiWidth = s.roiWidth;
+	record.roiHeight = s.roiHeight;
+	int valuesPerBin = 1;
+	int numberOfBins = StatisticsKernel::downsampledBins(snapshot->histogram.size(), static_cast<int>(header->maxHistogramBins), &valuesPerBin);
+	StatisticsKernel::downsampleHistogram(snapshot->histogram.constData(), snapshot->histogram.size(), valuesPerBin, numberOfBins, reinterpret_cast<quint32*>(slot + 1));
+	record.valuesPerBin = static_cast<uint32_t>(valuesPerBin);
+	record.numberOfBins = static_cast<uint32_t>(numberOfBins);
+
+	slot->sequence.store(sequence+2, std::memory_order_release);
+	segment.writeIndex = index+1;
+	header->writeIndex.store(index+1, std::memory_order_release);
+	this->writersInside.deref();
+}
+
+void StatisticsSharedMemory::slot_start(QString name) {
+	this->slot_stop();
+	this->segments[RAW].name = name + "_raw";
+	this->segments[PROCESSED].name = name + "_processed";
+	if(!this->createSegment(&this->segments[RAW], RAW) || !this->createSegment(&this->segments[PROCESSED], PROCESSED)){
+		this->destroySegment(&this->segments[RAW]);
+		this->destroySegment(&this->segments[PROCESSED]);
+		return;
+	}
+	this->exporting.storeRelease(1);
+	emit info(tr("Shared memory: Exporting statistics to ") + this->segments[RAW].name + tr(" and ") + this->segments[PROCESSED].name);
+	emit exportingChanged(true);
+}
+
+void StatisticsSharedMemory::slot_stop() {
+	if(this->exporting.fetchAndStoreOrdered(0) == 0){
+		return;
+	}
+	//a writer that is still inside only finishes its current record
+	while(this->writersInside.loadAcquire() != 0){
+		QThread::yieldCurrentThread();
+	}
+	this->destroySegment(&this->segments[RAW]);
+	this->destroySegment(&this->segments[PROCESSED]);
+	emit info(tr("Shared memory: Export stopped."));
+	emit exportingChanged(false);
+}
+
+bool StatisticsSharedMemory::createSegment(Segment* segment, BUFFER_SOURCE source) {
+	size_t headerSize = ((sizeof(SharedStatisticsHeader)+SHARED_STATISTICS_ALIGNMENT-1)/SHARED_STATISTICS_ALIGNMENT)*SHARED_STATISTICS_ALIGNMENT;
+	size_t slotSize = sizeof(SharedStatisticsSlot) + SHARED_MEMORY_HISTOGRAM_BINS*sizeof(quint32);
+	slotSize = ((slotSize+SHARED_STATISTICS_ALIGNMENT-1)/SHARED_STATISTICS_ALIGNMENT)*SHARED_STATISTICS_ALIGNMENT;
+	size_t size = headerSize + SHARED_MEMORY_SLOTS*slotSize;
+	void* memory = nullptr;
+
+#ifdef Q_OS_UNIX
+	//posix shared memory names start with a slash. an old segment of a crashed process is replaced
+	QByteArray posixName = ("/" + segment->name).toLocal8Bit();
+	shm_unlink(posixName.constData());
+	int fd = shm_open(posixName.constData(), O_CREAT | O_EXCL | O_RDWR, 0600);
+	if(fd >= 0 && ftruncate(fd, static_cast<off_t>(size)) == 0){
+		memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		if(memory == MAP_FAILED){
+			memory = nullptr;
+		}
+	}
+	if(fd >= 0){
+		close(fd);
+	}
+	if(memory == nullptr){
+		shm_unlink(posixName.constData());
+	}
+#else
+	segment->sharedMemory = new QSharedMemory(segment->name);
+	if(segment->sharedMemory->create(static_cast<int>(size))){
+		memory = segment->sharedMemory->data();
+	}else{
+		delete segment->sharedMemory;
+		segment->sharedMemory = nullptr;
+	}
+#endif
+	if(memory == nullptr){
+		emit error(tr("Shared memory: Could not create segment ") + segment->name);
+		return false;
+	}
+
+	//all slots start with an even sequence, readers see writeIndex 0 until the first record is written
+	memset(memory, 0, size);
+	SharedStatisticsHeader* header = new(memory) SharedStatisticsHeader;
+	header->magic = SHARED_STATISTICS_MAGIC;
+	header->version = SHARED_STATISTICS_VERSION;
+	header->source = static_cast<uint32_t>(source);
+	header->slotCount = SHARED_MEMORY_SLOTS;
+	header->maxHistogramBins = SHARED_MEMORY_HISTOGRAM_BINS;
+	header->slotSize = slotSize;
+	header->firstSlotOffset = headerSize;
+	header->writeIndex.store(0, std::memory_order_release);
+	segment->header = header;
+	segment->size = size;
+	segment->writeIndex = 0;
+	return true;
+}
+
+void StatisticsSharedMemory::destroySegment(Segment* segment) {
+	if(segment->header == nullptr){
+		return;
+	}
+#ifdef Q_OS_UNIX
+	munmap(segment->header, segment->size);
+	shm_unlink(("/" + segment->name).toLocal8Bit().constData());
+#else
+	delete segment->sharedMemory;
+	segment->sharedMemory = nullptr;
+#endif
+	segment->header = nullptr;
+	segment->size = 0;
+}
@@ -0,0 +1,87 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#ifndef STATISTICSSHAREDMEMORY_H
+#define STATISTICSSHAREDMEMORY_H
+
+#define SHARED_MEMORY_SLOTS 64
+#define SHARED_MEMORY_HISTOGRAM_BINS 256
+#define DEFAULT_SHARED_MEMORY_NAME "octproz_imagestatistics"
+
+#include <QObject>
+#include <QAtomicInt>
+#include <QString>
+#include "statisticssink.h"
+#include "sharedstatisticslayout.h"
+
+#ifndef Q_OS_UNIX
+#include <QSharedMemory>
+#endif
+
+//StatisticsSharedMemory writes every statistics result with a downsampled histogram into a seqlock protected ring in shared
+//memory, see sharedstatisticslayout.h. There is one segment per buffer source, named <name>_raw and <name>_processed.
+//POSIX shared memory is used on unix, QSharedMemory on other platforms.
+class StatisticsSharedMemory : public QObject, public StatisticsSink
+{
+	Q_OBJECT
+public:
+	explicit StatisticsSharedMemory(QObject* parent = nullptr);
+	~StatisticsSharedMemory();
+
+	void record(BUFFER_SOURCE source, const StatisticsSnapshotData* snapshot) override;
+	bool isExporting() const {return this->exporting.loadAcquire() != 0;}
+
+private:
+	struct Segment {
+		QString name;
+		SharedStatisticsHeader* header;
+		size_t size;
+		quint64 writeIndex; //only used by the calculator thread of the source
+#ifndef Q_OS_UNIX
+		QSharedMemory* sharedMemory;
+#endif
+	};
+
+	Segment segments[2];
+	QAtomicInt exporting;
+	QAtomicInt writersInside;
+
+	bool createSegment(Segment* segment, BUFFER_SOURCE source);
+	void destroySegment(Segment* segment);
+
+signals:
+	void exportingChanged(bool exporting);
+	void info(QString);
+	void error(QString);
+
+public slots:
+	void slot_start(QString name);
+	void slot_stop();
+};
+
+#endif // STATISTICSSHAREDMEMORY_H
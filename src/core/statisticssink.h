@@ -0,0 +1,44 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#ifndef STATISTICSSINK_H
+#define STATISTICSSINK_H
+
+#include "frameingest.h"
+#include "statisticssnapshot.h"
+
+//receiver of every statistics result of an ImageStatisticsCalculator. record() is called by the calculator thread right
+//after a snapshot was published, the snapshot is only valid during the call. Implementations must not block or do I/O.
+class StatisticsSink
+{
+public:
+	virtual ~StatisticsSink() {}
+	virtual void record(BUFFER_SOURCE source, const StatisticsSnapshotData* snapshot) = 0;
+};
+
+#endif // STATISTICSSINK_H
@@ -0,0 +1,118 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#include "statisticssnapshot.h"
+
+
+StatisticsSnapshot::StatisticsSnapshot() {
+	this->d = nullptr;
+}
+
+StatisticsSnapshot::StatisticsSnapshot(StatisticsSnapshotData* data) {
+	this->d = data;
+}
+
+StatisticsSnapshot::StatisticsSnapshot(const StatisticsSnapshot& other) {
+	this->d = other.d;
+	if(this->d != nullptr){
+		this->d->refCount.ref();
+	}
+}
+
+StatisticsSnapshot& StatisticsSnapshot::operator=(const StatisticsSnapshot& other) {
+	if(other.d != nullptr){
+		other.d->refCount.ref();
+	}
+	StatisticsSnapshotData* old = this->d;
+	this->d = other.d;
+	release(old);
+	return *this;
+}
+
+StatisticsSnapshot::~StatisticsSnapshot() {
+	release(this->d);
+}
+
+void StatisticsSnapshot::release(StatisticsSnapshotData* data) {
+	//snapshots are only deleted after the pool released its reference
+	if(data != nullptr && !data->refCount.deref()){
+		delete data;
+	}
+}
+
+
+StatisticsSnapshotPool::StatisticsSnapshotPool() {
+	this->nextSequenceNumber = 1;
+	for(int i = 0; i < STATISTICS_SNAPSHOT_POOL_SIZE; i++){
+		StatisticsSnapshotData* data = new StatisticsSnapshotData();
+		data->refCount.storeRelaxed(1);
+		this->snapshots.append(data);
+	}
+}
+
+StatisticsSnapshotPool::~StatisticsSnapshotPool() {
+	//snapshots that are still referenced by consumers are deleted by their last handle
+	StatisticsSnapshot::release(this->latestSnapshot.fetchAndStoreOrdered(nullptr));
+	for(StatisticsSnapshotData* data : qAsConst(this->snapshots)){
+		StatisticsSnapshot::release(data);
+	}
+}
+
+StatisticsSnapshotData* StatisticsSnapshotPool::beginWrite() {
+	//claim a snapshot that is only referenced by the pool
+	for(StatisticsSnapshotData* data : qAsConst(this->snapshots)){
+		if(data->refCount.testAndSetAcquire(1, 2)){
+			return data;
+		}
+	}
+	StatisticsSnapshotData* data = new StatisticsSnapshotData();
+	data->refCount.storeRelaxed(2);
+	this->snapshots.append(data);
+	return data;
+}
+
+void StatisticsSnapshotPool::publish(StatisticsSnapshotData* data) {
+	//reference of the producer is handed over to latestSnapshot
+	data->sequenceNumber = this->nextSequenceNumber++;
+	StatisticsSnapshot::release(this->latestSnapshot.fetchAndStoreOrdered(data));
+}
+
+StatisticsSnapshot StatisticsSnapshotPool::latest() const {
+	forever{
+		StatisticsSnapshotData* data = this->latestSnapshot.loadAcquire();
+		if(data == nullptr){
+			return StatisticsSnapshot();
+		}
+		//the snapshot can not be deleted while the pool exists. if it was replaced and recycled meanwhile, the reference is dropped and the new latest snapshot is used
+		data->refCount.ref();
+		if(this->latestSnapshot.loadAcquire() == data){
+			return StatisticsSnapshot(data);
+		}
+		StatisticsSnapshot::release(data);
+	}
+}
@@ -0,0 +1,109 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#ifndef STATISTICSSNAPSHOT_H
+#define STATISTICSSNAPSHOT_H
+
+#define STATISTICS_SNAPSHOT_POOL_SIZE 4 //initial number of snapshots per pool, the pool grows if all snapshots are in use
+
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include <QMetaType>
+#include <QVector>
+
+struct ImageStatistics {
+	int pixels;
+	qreal max;
+	qreal min;
+	qreal sum;
+	qreal average;
+	qreal stdDeviation;
+	qreal coeffOfVariation;
+	qreal percentile5;
+	qreal median;
+	qreal percentile95;
+	int roiX;
+	int roiY;
+	int roiWidth;
+	int roiHeight;
+};
+
+struct StatisticsSnapshotData {
+	QAtomicInt refCount; //the pool holds one reference to every snapshot, a snapshot is free if this is the only reference
+	quint64 sequenceNumber; //increases with every published snapshot of a pool
+	quint64 frameSequenceNumber;
+	qint64 timestamp; //microseconds since epoch at which the frame was received
+	ImageStatistics statistics;
+	QVector<quint32> histogram; //bin i counts samples with value i
+};
+
+//StatisticsSnapshot is a reference counted handle to an immutable statistics and histogram result
+class StatisticsSnapshot
+{
+public:
+	StatisticsSnapshot();
+	StatisticsSnapshot(const StatisticsSnapshot& other);
+	StatisticsSnapshot& operator=(const StatisticsSnapshot& other);
+	~StatisticsSnapshot();
+
+	bool isNull() const {return this->d == nullptr;}
+	quint64 getSequenceNumber() const {return this->d == nullptr ? 0 : this->d->sequenceNumber;}
+	quint64 getFrameSequenceNumber() const {return this->d->frameSequenceNumber;}
+	qint64 getTimestamp() const {return this->d->timestamp;}
+	const ImageStatistics& getStatistics() const {return this->d->statistics;}
+	const QVector<quint32>& getHistogram() const {return this->d->histogram;}
+
+private:
+	friend class StatisticsSnapshotPool;
+	explicit StatisticsSnapshot(StatisticsSnapshotData* data); //takes over a reference that is already counted
+	static void release(StatisticsSnapshotData* data);
+
+	StatisticsSnapshotData* d;
+};
+
+//StatisticsSnapshotPool recycles snapshots, so publishing results does not allocate memory in steady state.
+//There must be only one producer thread (beginWrite/publish), latest() can be called from any thread and does not lock.
+class StatisticsSnapshotPool
+{
+public:
+	StatisticsSnapshotPool();
+	~StatisticsSnapshotPool();
+
+	StatisticsSnapshotData* beginWrite();
+	void publish(StatisticsSnapshotData* data);
+	StatisticsSnapshot latest() const;
+
+private:
+	QVector<StatisticsSnapshotData*> snapshots; //only accessed by the producer thread
+	QAtomicPointer<StatisticsSnapshotData> latestSnapshot; //holds one reference to the latest snapshot
+	quint64 nextSequenceNumber;
+};
+
+Q_DECLARE_METATYPE(StatisticsSnapshot)
+
+#endif // STATISTICSSNAPSHOT_H
@@ -39,36 +39,31 @@ HistogramPlot::HistogramPlot(QWidget* parent) : QCustomPlot(parent)
 	this->axisRect()->setAutoMargins(QCP::msNone);
 	this->axisRect()->setMargins(QMargins(0,0,0,0));
 
-	//configure appearance of bars in plot area
-	this->bars = new QCPBars(this->xAxis, this->yAxis);
-//	this->bars->setAntialiased(false);
-//	this->bars->setAntialiasedScatters(false);
-//	this->bars->setAntialiasedFill(false);
-//	this->setNoAntialiasingOnDrag(true);
-	QPen barPen = QPen(QColor(200, 200, 200));
-	barPen.setWidth(1);
-	this->bars->setPen(barPen);
-	this->bars->setBrush(QColor(150, 150, 150));
-	this->bars->setWidthType(QCPBars::wtPlotCoords);
-	this->bars->setWidth(1.0);
+	//configure appearance of histogram in plot area. the histogram has its own buffered layer, so new histogram data only repaints this layer
+	this->addLayer("histogram", this->layer("main"), QCustomPlot::limAbove);
+	this->layer("histogram")->setMode(QCPLayer::lmBuffered);
+	this->histogram = new HistogramPlottable(this->xAxis, this->yAxis);
+	this->histogram->setLayer("histogram");
+	this->histogram->setAntialiased(false);
+	QPen histogramPen = QPen(QColor(200, 200, 200));
+	histogramPen.setWidth(1);
+	this->histogram->setPen(histogramPen);
+	this->histogram->setBrush(QColor(150, 150, 150));
 
 	//set user interactions
 	this->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);
 
-	//init bools for frames per second limitation and autoscale on first run
 	this->updatingEnabled = false;
-	this->fpsLimit = false;
 
 	//fill histogram plot with arbitrary data to see appearance of plot without providing actual data
-	QVector<double> x3(4096), y3(4096);
-	int center = x3.size()/2;
-	for (int i=0; i<x3.size(); i++){
-		x3[i] = i;
+	QVector<quint32> y3(4096);
+	int center = y3.size()/2;
+	for (int i=0; i<y3.size(); i++){
 		double xi = i - center;
-		double xiNorm = xi / (x3.size() - 1);
-		y3[i] = 512 * exp(-64*(xiNorm*xiNorm));
+		double xiNorm = xi / (y3.size() - 1);
+		y3[i] = static_cast<quint32>(512 * exp(-64*(xiNorm*xiNorm)));
 	}
-	this->bars->setData(x3, y3);
+	this->histogram->setBins(std::move(y3));
 	this->fitView();
 }
 
@@ -140,15 +135,15 @@ void HistogramPlot::slot_saveToDisk() {
 	}
 }
 
-void HistogramPlot::slot_updatePlot(QVector<qreal>* x, QVector<qreal>* y) {
-	if(!this->fpsLimit){
-		this->fpsLimit = true;
-		this->bars->setData(*x, *y, true);
-		this->replot();
-		QTimer::singleShot(1000/MAX_FPS, this, SLOT(slot_disableFpsLimit()));
+void HistogramPlot::slot_updatePlot(StatisticsSnapshot snapshot) {
+	//update rate is limited by the refresh scheduler of the extension
+	//refit view if the number of bins changed (e.g. bit depth of the data changed), otherwise only the histogram layer is repainted
+	bool binsChanged = this->histogram->getNumberOfBins() != (snapshot.isNull() ? 0 : snapshot.getHistogram().size());
+	this->histogram->setSnapshot(snapshot);
+	if(binsChanged){
+		this->fitView();
+	}else{
+		this->histogram->layer()->replot();
 	}
 }
 
-void HistogramPlot::slot_disableFpsLimit() {
-	this->fpsLimit = false;
-}
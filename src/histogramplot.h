@@ -28,10 +28,8 @@
 #ifndef HISTOGRAMPLOT_H
 #define HISTOGRAMPLOT_H
 
-#define MAX_FPS 25
-
-#include <QTimer>
 #include "qcustomplot.h"
+#include "histogramplottable.h"
 
 class HistogramPlot : public QCustomPlot
 {
@@ -40,9 +38,8 @@ public:
 	explicit HistogramPlot(QWidget* parent = nullptr);
 
 private:
-	QCPBars* bars;
+	HistogramPlottable* histogram;
 	bool updatingEnabled;
-	bool fpsLimit;
 
 	void setAxisColor(QColor color);
 	void zoomOutSlightly();
@@ -58,8 +55,7 @@ signals:
 public slots:
 	virtual void mouseDoubleClickEvent(QMouseEvent* event) override;
 	void slot_saveToDisk();
-	void slot_updatePlot(QVector<qreal>* x, QVector<qreal>* y);
-	void slot_disableFpsLimit();
+	void slot_updatePlot(StatisticsSnapshot snapshot);
 	void slot_enableUpdating(bool enable){this->updatingEnabled = enable;}
 };
 
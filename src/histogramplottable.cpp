@@ -0,0 +1,131 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#include "histogramplottable.h"
+
+
+HistogramPlottable::HistogramPlottable(QCPAxis* keyAxis, QCPAxis* valueAxis) : QCPAbstractPlottable(keyAxis, valueAxis) {
+	this->bins = nullptr;
+	this->numberOfBins = 0;
+	this->maxCount = 0;
+	this->setSelectable(QCP::stNone);
+}
+
+void HistogramPlottable::setBins(QVector<quint32> bins) {
+	this->ownBins = std::move(bins);
+	this->snapshot = StatisticsSnapshot();
+	this->bins = this->ownBins.constData();
+	this->numberOfBins = this->ownBins.size();
+	this->updateMaxCount();
+}
+
+void HistogramPlottable::setSnapshot(StatisticsSnapshot snapshot) {
+	this->ownBins.clear();
+	this->snapshot = snapshot;
+	this->bins = snapshot.isNull() ? nullptr : snapshot.getHistogram().constData();
+	this->numberOfBins = snapshot.isNull() ? 0 : snapshot.getHistogram().size();
+	this->updateMaxCount();
+}
+
+void HistogramPlottable::updateMaxCount() {
+	this->maxCount = 0;
+	for(int i = 0; i < this->numberOfBins; i++){
+		this->maxCount = qMax(this->maxCount, this->bins[i]);
+	}
+}
+
+double HistogramPlottable::selectTest(const QPointF& pos, bool onlySelectable, QVariant* details) const {
+	Q_UNUSED(pos);
+	Q_UNUSED(onlySelectable);
+	Q_UNUSED(details);
+	return -1;
+}
+
+QCPRange HistogramPlottable::getKeyRange(bool& foundRange, QCP::SignDomain inSignDomain) const {
+	Q_UNUSED(inSignDomain);
+	foundRange = this->numberOfBins > 0;
+	return QCPRange(-0.5, this->numberOfBins - 0.5);
+}
+
+QCPRange HistogramPlottable::getValueRange(bool& foundRange, QCP::SignDomain inSignDomain, const QCPRange& inKeyRange) const {
+	Q_UNUSED(inSignDomain);
+	Q_UNUSED(inKeyRange);
+	foundRange = this->numberOfBins > 0;
+	return QCPRange(0, this->maxCount);
+}
+
+void HistogramPlottable::draw(QCPPainter* painter) {
+	QCPAxis* keyAxis = this->mKeyAxis.data();
+	QCPAxis* valueAxis = this->mValueAxis.data();
+	int numberOfBins = this->numberOfBins;
+	if(keyAxis == nullptr || valueAxis == nullptr || numberOfBins == 0){
+		return;
+	}
+
+	//visible bin range
+	QCPRange range = keyAxis->range();
+	int firstBin = qBound(0, qFloor(range.lower + 0.5), numberOfBins-1);
+	int lastBin = qBound(0, qCeil(range.upper - 0.5), numberOfBins-1);
+
+	//number of bins per pixel column. groups are aligned to multiples of binsPerColumn, so the displayed data does not flicker while dragging
+	int columns = qMax(1, keyAxis->axisRect()->width());
+	int binsPerColumn = qMax(1, (lastBin - firstBin + 1)/columns);
+	firstBin = (firstBin/binsPerColumn)*binsPerColumn;
+	int groups = (lastBin - firstBin)/binsPerColumn + 1;
+
+	//step path: two points per group plus two points on the base line
+	const quint32* counts = this->bins;
+	double baseLine = valueAxis->coordToPixel(0);
+	this->path.resize(2*groups + 2);
+	QPointF* points = this->path.data();
+	for(int group = 0; group < groups; group++){
+		int start = firstBin + group*binsPerColumn;
+		int end = qMin(start + binsPerColumn, numberOfBins);
+		quint32 value = 0;
+		for(int i = start; i < end; i++){
+			value = qMax(value, counts[i]);
+		}
+		double y = valueAxis->coordToPixel(static_cast<double>(value));
+		points[2*group+1] = QPointF(keyAxis->coordToPixel(start - 0.5), y);
+		points[2*group+2] = QPointF(keyAxis->coordToPixel(end - 0.5), y);
+	}
+	points[0] = QPointF(points[1].x(), baseLine);
+	points[2*groups+1] = QPointF(points[2*groups].x(), baseLine);
+
+	this->applyDefaultAntialiasingHint(painter);
+	painter->setPen(this->mPen);
+	painter->setBrush(this->mBrush);
+	painter->drawPolygon(this->path);
+}
+
+void HistogramPlottable::drawLegendIcon(QCPPainter* painter, const QRectF& rect) const {
+	this->applyDefaultAntialiasingHint(painter);
+	painter->setPen(this->mPen);
+	painter->setBrush(this->mBrush);
+	painter->drawRect(rect);
+}
@@ -0,0 +1,69 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#ifndef HISTOGRAMPLOTTABLE_H
+#define HISTOGRAMPLOTTABLE_H
+
+#include <QVector>
+#include "qcustomplot.h"
+#include "statisticssnapshot.h"
+
+//plottable for integer histograms. Bin i is drawn at key i. All bins are drawn as one filled step path, bins that fall into the
+//same pixel column of the visible key range are drawn with their maximum count, so drawing time depends on the plot width and not on the number of bins.
+class HistogramPlottable : public QCPAbstractPlottable
+{
+	Q_OBJECT
+public:
+	explicit HistogramPlottable(QCPAxis* keyAxis, QCPAxis* valueAxis);
+
+	void setBins(QVector<quint32> bins);
+	void setSnapshot(StatisticsSnapshot snapshot);
+	int getNumberOfBins() const {return this->numberOfBins;}
+	quint32 getMaxCount() const {return this->maxCount;}
+
+	double selectTest(const QPointF& pos, bool onlySelectable, QVariant* details = nullptr) const override;
+	QCPRange getKeyRange(bool& foundRange, QCP::SignDomain inSignDomain = QCP::sdBoth) const override;
+	QCPRange getValueRange(bool& foundRange, QCP::SignDomain inSignDomain = QCP::sdBoth, const QCPRange& inKeyRange = QCPRange()) const override;
+
+protected:
+	void draw(QCPPainter* painter) override;
+	void drawLegendIcon(QCPPainter* painter, const QRectF& rect) const override;
+
+private:
+	void updateMaxCount();
+
+	//bins point either to ownBins or to the histogram of snapshot, which keeps the data alive without copying it
+	QVector<quint32> ownBins;
+	StatisticsSnapshot snapshot;
+	const quint32* bins;
+	int numberOfBins;
+	quint32 maxCount;
+	QPolygonF path;
+};
+
+#endif // HISTOGRAMPLOTTABLE_H
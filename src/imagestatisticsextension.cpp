@@ -30,6 +30,8 @@
 
 ImageStatisticsExtension::ImageStatisticsExtension() : Extension() {
 	qRegisterMetaType<AcquisitionParams >("BUFFER_SOURCE");
+	qRegisterMetaType<FrameHandle>("FrameHandle");
+	qRegisterMetaType<StatisticsSnapshot>("StatisticsSnapshot");
 
 	//init extension
 	this->setType(EXTENSION);
@@ -41,61 +43,163 @@ ImageStatisticsExtension::ImageStatisticsExtension() : Extension() {
 	this->form = new ImageStatisticsExtensionForm();
 	this->roiSelect = this->form->getROISelector();
 	this->widgetDisplayed = false;
-	connect(this->form, &ImageStatisticsExtensionForm::parametersUpdated, this, &ImageStatisticsExtension::storeParameters);
+	this->active = false;
+	this->previewVisible = false;
+	this->headless = true;
+	this->bufferSource = PROCESSED;
+	this->loggedSequenceNumberRaw = 0;
+	this->loggedSequenceNumberProcessed = 0;
+	connect(this->form, &ImageStatisticsExtensionForm::parametersUpdated, this, &ImageStatisticsExtension::scheduleStoreParameters);
 	connect(this->form, &ImageStatisticsExtensionForm::sourceChanged, this, &ImageStatisticsExtension::setBufferSource);
-	connect(this->form, &ImageStatisticsExtensionForm::frameNrChanged, this, &ImageStatisticsExtension::setFrameNr);
-	connect(this->form, &ImageStatisticsExtensionForm::bufferNrChanged, this, &ImageStatisticsExtension::setBufferNr);
-	connect(this, &ImageStatisticsExtension::maxFrames, this->form, &ImageStatisticsExtensionForm::slot_setMaximumFrameNr);
-	connect(this, &ImageStatisticsExtension::maxBuffers, this->form, &ImageStatisticsExtensionForm::slot_setMaximumBufferNr);
-	connect(this, &ImageStatisticsExtension::newFrame, this->roiSelect, &ROISelector::slot_receiveFrame);
 	connect(this->roiSelect, &ROISelector::info, this, &ImageStatisticsExtension::info);
 	connect(this->roiSelect, &ROISelector::error, this, &ImageStatisticsExtension::error);
-
-	//init multi buffers
-	this->frameBuffersRaw.resize(NUMBER_OF_BUFFERS);
-	this->frameBuffersProcessed.resize(NUMBER_OF_BUFFERS);
-	for(int i = 0; i < NUMBER_OF_BUFFERS; i++){
-		this->frameBuffersRaw[i] = nullptr;
-		this->frameBuffersProcessed[i] = nullptr;
+	connect(this->roiSelect, &ROISelector::visibilityChanged, this, &ImageStatisticsExtension::setPreviewVisible);
+	connect(this->form, &ImageStatisticsExtensionForm::visibilityChanged, this, &ImageStatisticsExtension::setWindowVisible);
+
+	//parameter changes are coalesced, moving the window or dragging a slider would otherwise store the settings many times per second
+	this->settingsStoreTimer.setSingleShot(true);
+	this->settingsStoreTimer.setInterval(SETTINGS_STORE_DELAY_MS);
+	connect(&this->settingsStoreTimer, &QTimer::timeout, this, &ImageStatisticsExtension::storeParameters);
+
+	//statistics are written to the log periodically while the window is hidden or minimized
+	this->headlessLogTimer.setInterval(HEADLESS_LOG_INTERVAL_MS);
+	connect(&this->headlessLogTimer, &QTimer::timeout, this, &ImageStatisticsExtension::logHeadlessStatistics);
+
+	//init frame ingest and statistics calculator for each buffer source. both sources can be active at the same time
+	this->ingestRaw = new FrameIngest(RAW, this);
+	this->ingestProcessed = new FrameIngest(PROCESSED, this);
+	this->statisticsCalculatorRaw = this->createCalculator(&this->statisticsCalculatorThreadRaw);
+	this->statisticsCalculatorProcessed = this->createCalculator(&this->statisticsCalculatorThreadProcessed);
+	this->statisticsCalculatorRaw->setSource(RAW);
+	this->statisticsCalculatorProcessed->setSource(PROCESSED);
+
+	//statistics results are recorded to disk by a separate thread, so file I/O never delays the calculators
+	this->recorder = new StatisticsRecorder();
+	this->recorder->moveToThread(&this->recorderThread);
+	connect(this->recorder, &StatisticsRecorder::info, this, &ImageStatisticsExtension::info);
+	connect(this->recorder, &StatisticsRecorder::error, this, &ImageStatisticsExtension::error);
+	connect(this->recorder, &StatisticsRecorder::recordingChanged, this->form, &ImageStatisticsExtensionForm::slot_setRecording);
+	connect(this->form, &ImageStatisticsExtensionForm::recordingStartRequested, this->recorder, &StatisticsRecorder::slot_start);
+	connect(this->form, &ImageStatisticsExtensionForm::recordingStopRequested, this->recorder, &StatisticsRecorder::slot_stop);
+	connect(&this->recorderThread, &QThread::finished, this->recorder, &StatisticsRecorder::deleteLater);
+	this->recorderThread.start();
+	this->statisticsCalculatorRaw->addSink(this->recorder);
+	this->statisticsCalculatorProcessed->addSink(this->recorder);
+
+	//statistics are published to local clients by a separate thread as well
+	this->publisher = new StatisticsPublisher();
+	this->publisher->moveToThread(&this->publisherThread);
+	connect(this->publisher, &StatisticsPublisher::info, this, &ImageStatisticsExtension::info);
+	connect(this->publisher, &StatisticsPublisher::error, this, &ImageStatisticsExtension::error);
+	connect(this->publisher, &StatisticsPublisher::publishingChanged, this->form, &ImageStatisticsExtensionForm::slot_setPublishing);
+	connect(this->form, &ImageStatisticsExtensionForm::publishingStartRequested, this->publisher, &StatisticsPublisher::slot_start);
+	connect(this->form, &ImageStatisticsExtensionForm::publishingStopRequested, this->publisher, &StatisticsPublisher::slot_stop);
+	connect(&this->publisherThread, &QThread::finished, this->publisher, &StatisticsPublisher::deleteLater);
+	this->publisherThread.start();
+	this->statisticsCalculatorRaw->addSink(this->publisher);
+	this->statisticsCalculatorProcessed->addSink(this->publisher);
+
+	//same-machine consumers can read the statistics from shared memory without any system call per frame
+	this->sharedMemory = new StatisticsSharedMemory(this);
+	connect(this->sharedMemory, &StatisticsSharedMemory::info, this, &ImageStatisticsExtension::info);
+	connect(this->sharedMemory, &StatisticsSharedMemory::error, this, &ImageStatisticsExtension::error);
+	connect(this->sharedMemory, &StatisticsSharedMemory::exportingChanged, this->form, &ImageStatisticsExtensionForm::slot_setSharedMemory);
+	connect(this->form, &ImageStatisticsExtensionForm::sharedMemoryStartRequested, this->sharedMemory, &StatisticsSharedMemory::slot_start);
+	connect(this->form, &ImageStatisticsExtensionForm::sharedMemoryStopRequested, this->sharedMemory, &StatisticsSharedMemory::slot_stop);
+	this->statisticsCalculatorRaw->addSink(this->sharedMemory);
+	this->statisticsCalculatorProcessed->addSink(this->sharedMemory);
+
+	//frame, latency and memory counters are aggregated by ingest and calculators and read by the metrics endpoint
+	this->ingestRaw->setMetrics(&this->metricsRaw);
+	this->ingestProcessed->setMetrics(&this->metricsProcessed);
+	this->statisticsCalculatorRaw->setMetrics(&this->metricsRaw);
+	this->statisticsCalculatorProcessed->setMetrics(&this->metricsProcessed);
+	this->metricsServer = new MetricsServer(this);
+	this->metricsServer->addSource(RAW, this->statisticsCalculatorRaw, &this->metricsRaw);
+	this->metricsServer->addSource(PROCESSED, this->statisticsCalculatorProcessed, &this->metricsProcessed);
+	connect(this->metricsServer, &MetricsServer::info, this, &ImageStatisticsExtension::info);
+	connect(this->metricsServer, &MetricsServer::error, this, &ImageStatisticsExtension::error);
+	connect(this->metricsServer, &MetricsServer::listeningChanged, this->form, &ImageStatisticsExtensionForm::slot_setMetrics);
+	connect(this->form, &ImageStatisticsExtensionForm::metricsStartRequested, this->metricsServer, &MetricsServer::slot_start);
+	connect(this->form, &ImageStatisticsExtensionForm::metricsStopRequested, this->metricsServer, &MetricsServer::slot_stop);
+
+	connect(this->ingestRaw, &FrameIngest::newRoiFrame, this->statisticsCalculatorRaw, &ImageStatisticsCalculator::slot_calculateStatistics);
+	connect(this->ingestProcessed, &FrameIngest::newRoiFrame, this->statisticsCalculatorProcessed, &ImageStatisticsCalculator::slot_calculateStatistics);
+	connect(this->roiSelect, &ROISelector::roiChanged, this->statisticsCalculatorRaw, &ImageStatisticsCalculator::slot_setROI);
+	connect(this->roiSelect, &ROISelector::roiChanged, this->statisticsCalculatorProcessed, &ImageStatisticsCalculator::slot_setROI);
+	QList<FrameIngest*> ingests = {this->ingestRaw, this->ingestProcessed};
+	for(FrameIngest* ingest : ingests){
+		connect(this->form, &ImageStatisticsExtensionForm::frameNrChanged, ingest, &FrameIngest::setFrameNr);
+		connect(this->form, &ImageStatisticsExtensionForm::bufferNrChanged, ingest, &FrameIngest::setBufferNr);
+		connect(this->roiSelect, &ROISelector::roiChanged, ingest, &FrameIngest::setROI);
+		connect(this->roiSelect, &ROISelector::viewportSizeChanged, ingest, &FrameIngest::setPreviewSize);
+		connect(this->roiSelect, &ROISelector::previewRegionChanged, ingest, &FrameIngest::setPreviewRegion);
+		connect(ingest, &FrameIngest::newPreviewFrame, this->roiSelect, &ROISelector::slot_receiveFrame);
+		connect(ingest, &FrameIngest::maxFrames, this->form, &ImageStatisticsExtensionForm::slot_setMaximumFrameNr);
+		connect(ingest, &FrameIngest::maxBuffers, this->form, &ImageStatisticsExtensionForm::slot_setMaximumBufferNr);
+		connect(ingest, &FrameIngest::info, this, [this](QString message){emit info(this->name + ": " + message);});
+		connect(ingest, &FrameIngest::error, this, [this](QString message){emit error(this->name + ":  " + message);});
 	}
-	this->copyBufferId = -1;
-	this->bytesPerFrameProcessed = 0;
-	this->bytesPerFrameRaw = 0;
-	this->isCalculating = false;
-	this->active = false;
 
-	//init statistic calculater
-	this->statisticsCalculator = new ImageStatisticsCalculator();
-	this->statisticsCalculator->moveToThread(&statisticsCalculatorThread);
-	connect(this->roiSelect, &ROISelector::roiChanged, this->statisticsCalculator, &ImageStatisticsCalculator::slot_setROI);
-	connect(this, &ImageStatisticsExtension::newFrame, this->statisticsCalculator, &ImageStatisticsCalculator::slot_calculateStatistics);
-	connect(this->statisticsCalculator, &ImageStatisticsCalculator::histogramCalculated, this->form, &ImageStatisticsExtensionForm::slot_updateHistogramPlot);
-	connect(this->statisticsCalculator, &ImageStatisticsCalculator::statisticsCalculated, this->form, &ImageStatisticsExtensionForm::slot_updateStatistics);
-	connect(this->statisticsCalculator, &ImageStatisticsCalculator::info, this, &ImageStatisticsExtension::info);
-	connect(this->statisticsCalculator, &ImageStatisticsCalculator::error, this, &ImageStatisticsExtension::error);
-	connect(&statisticsCalculatorThread, &QThread::finished, this->statisticsCalculator, &ImageStatisticsCalculator::deleteLater);
-	statisticsCalculatorThread.start();
-
-	//init variables for receiving buffers
-	this->lostBuffersRaw = 0;
-	this->lostBuffersProcessed = 0;
-	this->bufferSource = PROCESSED;
-	this->frameNr = 0;
-	this->bufferNr = 0;
-	this->framesPerBuffer = 0;
-	this->buffersPerVolume = 0;
+	//frames are captured by the data callbacks directly into memory-mapped files that are prepared on the gui thread
+	this->captureRaw = new FrameCapture(RAW, this);
+	this->captureProcessed = new FrameCapture(PROCESSED, this);
+	this->ingestRaw->setCapture(this->captureRaw);
+	this->ingestProcessed->setCapture(this->captureProcessed);
+	connect(this->ingestRaw, &FrameIngest::frameFormatChanged, this->captureRaw, &FrameCapture::slot_setFrameFormat);
+	connect(this->ingestProcessed, &FrameIngest::frameFormatChanged, this->captureProcessed, &FrameCapture::slot_setFrameFormat);
+	QList<FrameCapture*> captures = {this->captureRaw, this->captureProcessed};
+	for(FrameCapture* capture : captures){
+		connect(capture, &FrameCapture::info, this, [this](QString message){emit info(this->name + ": " + message);});
+		connect(capture, &FrameCapture::error, this, [this](QString message){emit error(this->name + ": " + message);});
+		connect(capture, &FrameCapture::captureChanged, this->form, [this](){
+			this->form->slot_setCapturing(this->captureRaw->isActive() || this->captureProcessed->isActive());
+		});
+	}
+	connect(this->form, &ImageStatisticsExtensionForm::captureRequested, this, &ImageStatisticsExtension::startCapture);
+	connect(this->form, &ImageStatisticsExtensionForm::captureCancelRequested, this, &ImageStatisticsExtension::cancelCapture);
+	this->updateIngestStates();
+
+	//histogram, statistics and preview are refreshed by one timer on the gui thread that only runs while the window is visible
+	this->refreshScheduler = new RefreshScheduler(this);
+	this->refreshScheduler->addStatisticsSource(RAW, this->statisticsCalculatorRaw);
+	this->refreshScheduler->addStatisticsSource(PROCESSED, this->statisticsCalculatorProcessed);
+	connect(this->refreshScheduler, &RefreshScheduler::statisticsChanged, this->form, [this](BUFFER_SOURCE source, StatisticsSnapshot snapshot){
+		this->form->slot_updateStatistics(source, snapshot.getStatistics());
+		this->form->slot_updateHistogramPlot(source, snapshot);
+	});
+	connect(this->refreshScheduler, &RefreshScheduler::refresh, this->roiSelect, &ROISelector::slot_refresh);
+	connect(this->refreshScheduler, &RefreshScheduler::refresh, this->form->getStripChart(), &StripChart::slot_refresh);
+	this->updateStripChartSource();
+	connect(this->form, &ImageStatisticsExtensionForm::refreshRateChanged, this->refreshScheduler, &RefreshScheduler::setRefreshRate);
+	connect(this->form, &ImageStatisticsExtensionForm::refreshRequested, this->refreshScheduler, &RefreshScheduler::invalidate);
+
+	//get initial roi, later roi changes are forwarded by roiChanged signal
+	this->roiSelect->slot_updateROI();
 }
 
 ImageStatisticsExtension::~ImageStatisticsExtension() {
-	statisticsCalculatorThread.quit();
-	statisticsCalculatorThread.wait();
-
+	this->flushParameters();
+	this->cancelCapture();
+
+	statisticsCalculatorThreadRaw.quit();
+	statisticsCalculatorThreadProcessed.quit();
+	statisticsCalculatorThreadRaw.wait();
+	statisticsCalculatorThreadProcessed.wait();
+
+	//recorder writes remaining records and closes the file when it is deleted after its thread finished
+	recorderThread.quit();
+	recorderThread.wait();
+	publisherThread.quit();
+	publisherThread.wait();
+	this->sharedMemory->slot_stop();
+	this->metricsServer->slot_stop();
+
+	//form can outlive the extension if it is owned by OCTproZ, the history belongs to the calculator
+	this->form->getStripChart()->setHistory(nullptr);
 	if(!this->widgetDisplayed){
 		delete this->form;
 	}
-
-	this->releaseFrameBuffers(this->frameBuffersProcessed);
-	this->releaseFrameBuffers(this->frameBuffersRaw);
 }
 
 QWidget* ImageStatisticsExtension::getWidget() {
@@ -106,11 +210,17 @@ QWidget* ImageStatisticsExtension::getWidget() {
 void ImageStatisticsExtension::activateExtension() {
 	//this method is called by OCTproZ as soon as user activates the extension. If the extension controls hardware components, they can be prepared, activated, initialized or started here.
 	this->active = true;
+	this->updateIngestStates();
+	if(this->headless){
+		this->headlessLogTimer.start();
+	}
 }
 
 void ImageStatisticsExtension::deactivateExtension() {
 	//this method is called by OCTproZ as soon as user deactivates the extension. If the extension controls hardware components, they can be deactivated, resetted or stopped here.
 	this->active = false;
+	this->updateIngestStates();
+	this->headlessLogTimer.stop();
 }
 
 void ImageStatisticsExtension::settingsLoaded(QVariantMap settings) {
@@ -124,141 +234,137 @@ void ImageStatisticsExtension::storeParameters() {
 	emit storeSettings(this->name, this->settingsMap);
 }
 
-void ImageStatisticsExtension::setFrameNr(int frameNr){
-	this->frameNr = frameNr;
+void ImageStatisticsExtension::scheduleStoreParameters() {
+	this->settingsStoreTimer.start();
+}
+
+void ImageStatisticsExtension::flushParameters() {
+	if(this->settingsStoreTimer.isActive()){
+		this->settingsStoreTimer.stop();
+		this->storeParameters();
+	}
 }
 
-void ImageStatisticsExtension::setBufferNr(int bufferNr){
-	this->bufferNr = bufferNr;
+void ImageStatisticsExtension::setBufferSource(BUFFER_SOURCE src) {
+	this->bufferSource = src;
+	this->updateIngestStates();
+	this->updateStripChartSource();
 }
 
-void ImageStatisticsExtension::releaseFrameBuffers(QVector<void *> buffers) {
-	for (int i = 0; i < buffers.size(); i++) {
-		if (buffers[i] != nullptr) {
-			free(buffers[i]);
-			buffers[i] = nullptr;
-		}
+void ImageStatisticsExtension::setPreviewVisible(bool visible) {
+	this->previewVisible = visible;
+	this->updateIngestStates();
+}
+
+void ImageStatisticsExtension::setWindowVisible(bool visible) {
+	//in headless mode only statistics are calculated, preview conversion and plotting are suspended
+	this->headless = !visible;
+	this->updateIngestStates();
+	if(this->headless && this->active){
+		this->headlessLogTimer.start();
+	}else{
+		this->headlessLogTimer.stop();
+	}
+	if(this->headless){
+		this->flushParameters();
+		this->refreshScheduler->stop();
+	}else{
+		this->refreshScheduler->invalidate();
+		this->refreshScheduler->start();
 	}
 }
 
+QString ImageStatisticsExtension::statisticsSummary(const ImageStatistics& statistics) {
+	return tr("average ") + QString::number(statistics.average) + tr(", std. deviation ") + QString::number(statistics.stdDeviation) + tr(", min ") + QString::number(statistics.min) + tr(", max ") + QString::number(statistics.max) + tr(", pixels ") + QString::number(statistics.pixels);
+}
+
+void ImageStatisticsExtension::logHeadlessStatistics() {
+	this->logStatistics(tr("Raw: "), this->statisticsCalculatorRaw, &this->loggedSequenceNumberRaw);
+	this->logStatistics(tr("Processed: "), this->statisticsCalculatorProcessed, &this->loggedSequenceNumberProcessed);
+}
+
+void ImageStatisticsExtension::logStatistics(const QString& sourceName, ImageStatisticsCalculator* calculator, quint64* loggedSequenceNumber) {
+	//every calculated frame increases the sequence number of the snapshot, so the number of frames since the last log entry is the difference
+	StatisticsSnapshot snapshot = calculator->getLatestSnapshot();
+	if(snapshot.isNull() || snapshot.getSequenceNumber() == *loggedSequenceNumber){
+		return;
+	}
+	quint64 frames = snapshot.getSequenceNumber() - *loggedSequenceNumber;
+	*loggedSequenceNumber = snapshot.getSequenceNumber();
+	emit info(this->name + ": " + sourceName + this->statisticsSummary(snapshot.getStatistics()) + tr(" (frames: ") + QString::number(frames) + ")");
+}
+
+void ImageStatisticsExtension::startCapture(QString fileName, int frames) {
+	if(!this->active){
+		emit error(this->name + ": " + tr("Capture not possible, extension is not active."));
+		return;
+	}
+	if(this->bufferSource != RAW_AND_PROCESSED){
+		FrameCapture* capture = this->bufferSource == RAW ? this->captureRaw : this->captureProcessed;
+		capture->slot_start(fileName, frames);
+		return;
+	}
+	//both sources are captured into separate files
+	QFileInfo fileInfo(fileName);
+	QString baseName = fileInfo.path() + "/" + fileInfo.completeBaseName();
+	QString suffix = fileInfo.suffix().isEmpty() ? QString() : "." + fileInfo.suffix();
+	this->captureRaw->slot_start(baseName + "_raw" + suffix, frames);
+	this->captureProcessed->slot_start(baseName + "_processed" + suffix, frames);
+}
+
+void ImageStatisticsExtension::cancelCapture() {
+	this->captureRaw->slot_cancel();
+	this->captureProcessed->slot_cancel();
+}
+
+ImageStatisticsCalculator* ImageStatisticsExtension::createCalculator(QThread* thread) {
+	ImageStatisticsCalculator* calculator = new ImageStatisticsCalculator();
+	calculator->moveToThread(thread);
+	connect(calculator, &ImageStatisticsCalculator::info, this, &ImageStatisticsExtension::info);
+	connect(calculator, &ImageStatisticsCalculator::error, this, &ImageStatisticsExtension::error);
+	connect(thread, &QThread::finished, calculator, &ImageStatisticsCalculator::deleteLater);
+	thread->start();
+	return calculator;
+}
+
+void ImageStatisticsExtension::updateIngestStates() {
+	bool rawEnabled = this->active && (this->bufferSource == RAW || this->bufferSource == RAW_AND_PROCESSED);
+	bool processedEnabled = this->active && (this->bufferSource == PROCESSED || this->bufferSource == RAW_AND_PROCESSED);
+	this->ingestRaw->setEnabled(rawEnabled);
+	this->ingestProcessed->setEnabled(processedEnabled);
+
+	//a capture of a disabled source would never receive its remaining frames, it is finished with the frames written so far
+	if(!rawEnabled){
+		this->captureRaw->slot_cancel();
+	}
+	if(!processedEnabled){
+		this->captureProcessed->slot_cancel();
+	}
+
+	//preview shows processed data if both sources are active
+	bool previewNeeded = this->previewVisible && !this->headless;
+	this->ingestRaw->setPreviewEnabled(previewNeeded && this->bufferSource == RAW);
+	this->ingestProcessed->setPreviewEnabled(previewNeeded && this->bufferSource != RAW);
+}
+
+void ImageStatisticsExtension::updateStripChartSource() {
+	//strip chart shows processed data if both sources are active
+	ImageStatisticsCalculator* calculator = this->bufferSource == RAW ? this->statisticsCalculatorRaw : this->statisticsCalculatorProcessed;
+	this->form->getStripChart()->setHistory(calculator->getHistory());
+}
+
 void ImageStatisticsExtension::rawDataReceived(void* buffer, unsigned bitDepth, unsigned int samplesPerLine, unsigned int linesPerFrame, unsigned int framesPerBuffer, unsigned int buffersPerVolume, unsigned int currentBufferNr) {
-	if(this->bufferSource == RAW && this->active){
-		if(!this->isCalculating && this->rawGrabbingAllowed){
-			this->isCalculating = true;
-
-			//calculate size of single frame
-			size_t bytesPerSample = static_cast<size_t>(ceil(static_cast<double>(bitDepth)/8.0));
-			size_t bytesPerFrame = samplesPerLine*linesPerFrame*bytesPerSample;
-
-			//check if number of frames per buffer has changed and emit maxFrames to update gui
-			if(this->framesPerBuffer != framesPerBuffer){
-				emit maxFrames(framesPerBuffer-1);
-				this->framesPerBuffer = framesPerBuffer;
-			}
-			//check if number of buffers per volume has changed and emit maxBuffers to update gui
-			if(this->buffersPerVolume != buffersPerVolume){
-				emit maxBuffers(buffersPerVolume-1);
-				this->buffersPerVolume = buffersPerVolume;
-			}
-
-			//check if buffer size changed and allocate buffer memory
-			if(this->frameBuffersRaw[0] == nullptr || this->bytesPerFrameRaw != bytesPerFrame){
-				if(bitDepth == 0 || samplesPerLine == 0 || linesPerFrame == 0 || framesPerBuffer == 0){
-					emit error(this->name + ":  " + tr("Invalid data dimensions!"));
-					return;
-				}
-				//(re)create copy buffers
-				if(this->frameBuffersRaw[0] != nullptr){
-					this->releaseFrameBuffers(this->frameBuffersRaw);
-				}
-				for (int i = 0; i < this->frameBuffersRaw.size(); i++) {
-					this->frameBuffersRaw[i] = static_cast<void*>(malloc(bytesPerFrame));
-				}
-				this->bytesPerFrameRaw = bytesPerFrame;
-			}
-
-			//copy single frame of received data and emit it for further processing
-			this->copyBufferId = (this->copyBufferId+1)%NUMBER_OF_BUFFERS;
-			char* frameInBuffer = static_cast<char*>(buffer);
-			if(this->frameNr>static_cast<int>(framesPerBuffer-1)){this->frameNr = static_cast<int>(framesPerBuffer-1);}
-			if(this->bufferNr>static_cast<int>(buffersPerVolume-1)){this->bufferNr = static_cast<int>(buffersPerVolume-1);}
-			if(this->bufferNr == -1 || this->bufferNr == static_cast<int>(currentBufferNr)){
-				memcpy(this->frameBuffersRaw[this->copyBufferId], &(frameInBuffer[bytesPerFrame*this->frameNr]), bytesPerFrame);
-				emit newFrame(this->frameBuffersRaw[this->copyBufferId], bitDepth, samplesPerLine, linesPerFrame);
-			}
-
-			this->isCalculating = false;
-		}
-		else{
-			this->lostBuffersRaw++;
-			emit info(this->name + ": " + tr("Raw buffer lost. Total lost raw buffers: ") + QString::number(lostBuffersRaw));
-			if(this->lostBuffersRaw>= INT_MAX){
-				this->lostBuffersRaw = 0;
-				emit info(this->name + ": " + tr("Lost raw buffer counter overflow. Counter set to zero."));
-			}
-		}
+	if(!this->rawGrabbingAllowed){
+		this->ingestRaw->reportLostBuffer();
+		return;
 	}
+	this->ingestRaw->receiveBuffer(buffer, bitDepth, samplesPerLine, linesPerFrame, framesPerBuffer, buffersPerVolume, currentBufferNr);
 }
 
 void ImageStatisticsExtension::processedDataReceived(void* buffer, unsigned int bitDepth, unsigned int samplesPerLine, unsigned int linesPerFrame, unsigned int framesPerBuffer, unsigned int buffersPerVolume, unsigned int currentBufferNr) {
-	if(this->bufferSource == PROCESSED && this->active){
-		if(!this->isCalculating && this->processedGrabbingAllowed){
-			//check if current buffer is selected. If it is not selected discard it and do nothing (just return).
-			if(this->bufferNr>static_cast<int>(buffersPerVolume-1)){this->bufferNr = static_cast<int>(buffersPerVolume-1);}
-			if(!(this->bufferNr == -1 || this->bufferNr == static_cast<int>(currentBufferNr))){
-				return;
-			}
-
-			this->isCalculating = true;
-
-			//calculate size of single frame
-			size_t bytesPerSample = static_cast<size_t>(ceil(static_cast<double>(bitDepth)/8.0));
-			size_t bytesPerFrame = samplesPerLine*linesPerFrame*bytesPerSample;
-
-			//check if number of frames per buffer has changed and emit maxFrames to update gui
-			if(this->framesPerBuffer != framesPerBuffer){
-				emit maxFrames(framesPerBuffer-1);
-				this->framesPerBuffer = framesPerBuffer;
-			}
-			//check if number of buffers per volume has changed and emit maxBuffers to update gui
-			if(this->buffersPerVolume != buffersPerVolume){
-				emit maxBuffers(buffersPerVolume-1);
-				this->buffersPerVolume = buffersPerVolume;
-			}
-
-			//check if buffer size changed and allocate buffer memory
-			if(this->frameBuffersProcessed[0] == nullptr || this->bytesPerFrameProcessed != bytesPerFrame){
-				if(bitDepth == 0 || samplesPerLine == 0 || linesPerFrame == 0 || framesPerBuffer == 0){
-					emit error(this->name + ":  " + tr("Invalid data dimensions!"));
-					return;
-				}
-				//(re)create copy buffers
-				if(this->frameBuffersProcessed[0] != nullptr){
-					this->releaseFrameBuffers(this->frameBuffersProcessed);
-				}
-				for (int i = 0; i < this->frameBuffersProcessed.size(); i++) {
-					this->frameBuffersProcessed[i] = static_cast<void*>(malloc(bytesPerFrame));
-				}
-				this->bytesPerFrameProcessed = bytesPerFrame;
-			}
-
-			//copy single frame of received data and emit it for further processing
-			this->copyBufferId = (this->copyBufferId+1)%NUMBER_OF_BUFFERS;
-			char* frameInBuffer = static_cast<char*>(buffer);
-			if(this->frameNr>static_cast<int>(framesPerBuffer-1)){this->frameNr = static_cast<int>(framesPerBuffer-1);}
-			memcpy(this->frameBuffersProcessed[this->copyBufferId], &(frameInBuffer[bytesPerFrame*this->frameNr]), bytesPerFrame);
-			emit newFrame(this->frameBuffersProcessed[this->copyBufferId], bitDepth, samplesPerLine, linesPerFrame);
-
-			this->isCalculating = false;
-		}
-		else{
-			this->lostBuffersProcessed++;
-			emit info(this->name + ": " + tr("Processed buffer lost. Total lost buffers: ") + QString::number(lostBuffersProcessed));
-			if(this->lostBuffersProcessed>= INT_MAX){
-				this->lostBuffersProcessed = 0;
-				emit info(this->name + ": " + tr("Lost processed buffer counter overflow. Counter set to zero."));
-			}
-		}
+	if(!this->processedGrabbingAllowed){
+		this->ingestProcessed->reportLostBuffer();
+		return;
 	}
+	this->ingestProcessed->receiveBuffer(buffer, bitDepth, samplesPerLine, linesPerFrame, framesPerBuffer, buffersPerVolume, currentBufferNr);
 }
-
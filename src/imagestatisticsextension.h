@@ -28,14 +28,22 @@
 #ifndef DEMOEXTENSION_H
 #define DEMOEXTENSION_H
 
-#define NUMBER_OF_BUFFERS 2
+#define HEADLESS_LOG_INTERVAL_MS 10000
+#define SETTINGS_STORE_DELAY_MS 1000 //parameter changes are stored after this time without further changes
 
 #include <QCoreApplication>
 #include <QThread>
+#include <QTimer>
+#include <QFileInfo>
 #include "octproz_devkit.h"
 #include "imagestatisticsextensionform.h"
 #include "imagestatisticscalculator.h"
 #include "roiselector.h"
+#include "frameingest.h"
+#include "refreshscheduler.h"
+#include "statisticsrecorder.h"
+#include "statisticspublisher.h"
+#include "framecapture.h"
 
 
 class ImageStatisticsExtension : public Extension
@@ -43,7 +51,10 @@ class ImageStatisticsExtension : public Extension
 	Q_OBJECT
 	Q_PLUGIN_METADATA(IID Extension_iid)
 	Q_INTERFACES(Extension Plugin)
-	QThread statisticsCalculatorThread;
+	QThread statisticsCalculatorThreadRaw;
+	QThread statisticsCalculatorThreadProcessed;
+	QThread recorderThread;
+	QThread publisherThread;
 
 public:
 	ImageStatisticsExtension();
@@ -56,41 +67,50 @@ public:
 
 
 private:
-	ImageStatisticsCalculator* statisticsCalculator;
+	ImageStatisticsCalculator* statisticsCalculatorRaw;
+	ImageStatisticsCalculator* statisticsCalculatorProcessed;
+	FrameIngest* ingestRaw;
+	FrameIngest* ingestProcessed;
 	ROISelector* roiSelect;
-	QVector<void*> frameBuffersRaw;
-	QVector<void*> frameBuffersProcessed;
-	int copyBufferId;
-	size_t bytesPerFrameRaw;
-	size_t bytesPerFrameProcessed;
+	RefreshScheduler* refreshScheduler;
+	StatisticsRecorder* recorder;
+	StatisticsPublisher* publisher;
+	StatisticsSharedMemory* sharedMemory;
+	MetricsServer* metricsServer;
+	StatisticsMetrics metricsRaw;
+	StatisticsMetrics metricsProcessed;
+	FrameCapture* captureRaw;
+	FrameCapture* captureProcessed;
 
 	ImageStatisticsExtensionForm* form;
 	bool widgetDisplayed;
-	bool isCalculating;
 	bool active;
-
-	int lostBuffersRaw;
-	int lostBuffersProcessed;
+	bool previewVisible;
+	bool headless;
 	BUFFER_SOURCE bufferSource;
-	int frameNr;
-	int bufferNr;
-	unsigned int framesPerBuffer;
-	unsigned int buffersPerVolume;
+	QTimer headlessLogTimer;
+	QTimer settingsStoreTimer;
+	quint64 loggedSequenceNumberRaw;
+	quint64 loggedSequenceNumberProcessed;
 
-	void releaseFrameBuffers(QVector<void*> buffers);
+	ImageStatisticsCalculator* createCalculator(QThread* thread);
+	void updateIngestStates();
+	void updateStripChartSource();
+	void logStatistics(const QString& sourceName, ImageStatisticsCalculator* calculator, quint64* loggedSequenceNumber);
+	QString statisticsSummary(const ImageStatistics& statistics);
 
 public slots:
 	void storeParameters();
-	void setBufferSource(BUFFER_SOURCE src){this->bufferSource = src;}
-	void setFrameNr(int frameNr);
-	void setBufferNr(int bufferNr);
+	void scheduleStoreParameters();
+	void flushParameters();
+	void setBufferSource(BUFFER_SOURCE src);
+	void setPreviewVisible(bool visible);
+	void setWindowVisible(bool visible);
+	void startCapture(QString fileName, int frames);
+	void cancelCapture();
+	void logHeadlessStatistics();
 	virtual void rawDataReceived(void* buffer, unsigned int bitDepth, unsigned int samplesPerLine, unsigned int linesPerFrame, unsigned int framesPerBuffer, unsigned int buffersPerVolume, unsigned int currentBufferNr) override;
 	virtual void processedDataReceived(void* buffer, unsigned int bitDepth, unsigned int samplesPerLine, unsigned int linesPerFrame, unsigned int framesPerBuffer, unsigned int buffersPerVolume, unsigned int currentBufferNr) override;
-
-signals:
-	void newFrame(void* frame, unsigned int bitDepth, unsigned int samplesPerLine, unsigned int linesPerFrame);
-	void maxFrames(int max);
-	void maxBuffers(int max);
 };
 
 #endif // DEMOEXTENSION_H
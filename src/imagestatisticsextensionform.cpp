@@ -27,6 +27,7 @@
 
 #include "imagestatisticsextensionform.h"
 #include "ui_imagestatisticsextensionform.h"
+#include <QFileDialog>
 
 ImageStatisticsExtensionForm::ImageStatisticsExtensionForm(QWidget *parent) :
 	QWidget(parent),
@@ -36,9 +37,13 @@ ImageStatisticsExtensionForm::ImageStatisticsExtensionForm(QWidget *parent) :
 
 	this->updateHistogramOnce = false;
 	this->updateStatisticsOnce = false;
+	this->windowVisible = false;
 
-	QStringList srcOptions = { "Raw", "Processed"};
+	QStringList srcOptions = { "Raw", "Processed", "Raw + Processed"};
 	this->ui->comboBox_source->addItems(srcOptions);
+	this->ui->comboBox_source->setCurrentIndex(PROCESSED);
+	this->parameters.bufferSrc = PROCESSED;
+	this->updateStatisticsColumns();
 
 	connect(this->ui->comboBox_source, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &ImageStatisticsExtensionForm::slot_setSource);
 	connect(this->ui->pushButton_updateHistogram, &QPushButton::clicked, this, &ImageStatisticsExtensionForm::slot_updateHistogramPlotOnce);
@@ -55,6 +60,36 @@ ImageStatisticsExtensionForm::ImageStatisticsExtensionForm(QWidget *parent) :
 	this->ui->spinBox_buffer->setMinimum(-1);
 	this->ui->spinBox_buffer->setSpecialValueText(tr("All"));
 	connect(this->ui->spinBox_buffer, QOverload<int>::of(&QSpinBox::valueChanged), this, &ImageStatisticsExtensionForm::slot_setBufferNr);
+
+	this->parameters.previewFps = DEFAULT_PREVIEW_FPS;
+	this->ui->spinBox_previewFps->setValue(DEFAULT_PREVIEW_FPS);
+	connect(this->ui->spinBox_previewFps, QOverload<int>::of(&QSpinBox::valueChanged), this, &ImageStatisticsExtensionForm::slot_setPreviewFps);
+
+	this->parameters.refreshRate = DEFAULT_REFRESH_RATE;
+	this->ui->spinBox_refreshRate->setValue(DEFAULT_REFRESH_RATE);
+	connect(this->ui->spinBox_refreshRate, QOverload<int>::of(&QSpinBox::valueChanged), this, &ImageStatisticsExtensionForm::slot_setRefreshRate);
+
+	this->parameters.displayWindow = 0;
+	this->parameters.displayLevel = 0;
+	this->parameters.displayGamma = 1.0;
+	this->parameters.displayLog = false;
+	connect(this->ui->doubleSpinBox_window, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, &ImageStatisticsExtensionForm::slot_setDisplayMapping);
+	connect(this->ui->doubleSpinBox_level, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, &ImageStatisticsExtensionForm::slot_setDisplayMapping);
+	connect(this->ui->doubleSpinBox_gamma, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, &ImageStatisticsExtensionForm::slot_setDisplayMapping);
+	connect(this->ui->checkBox_log, &QAbstractButton::toggled, this, &ImageStatisticsExtensionForm::slot_setDisplayMapping);
+
+	connect(this->ui->pushButton_record, &QAbstractButton::clicked, this, &ImageStatisticsExtensionForm::slot_record);
+	connect(this->ui->pushButton_capture, &QAbstractButton::clicked, this, &ImageStatisticsExtensionForm::slot_capture);
+	connect(this->ui->checkBox_publish, &QAbstractButton::clicked, this, &ImageStatisticsExtensionForm::slot_enablePublishing);
+	this->parameters.publishEnabled = false;
+	this->parameters.publishAddress = DEFAULT_PUBLISHER_ADDRESS;
+	this->parameters.publishHistogramBins = DEFAULT_PUBLISHER_HISTOGRAM_BINS;
+	connect(this->ui->checkBox_sharedMemory, &QAbstractButton::clicked, this, &ImageStatisticsExtensionForm::slot_enableSharedMemory);
+	this->parameters.sharedMemoryEnabled = false;
+	this->parameters.sharedMemoryName = DEFAULT_SHARED_MEMORY_NAME;
+	connect(this->ui->checkBox_metrics, &QAbstractButton::clicked, this, &ImageStatisticsExtensionForm::slot_enableMetrics);
+	this->parameters.metricsEnabled = false;
+	this->parameters.metricsPort = DEFAULT_METRICS_PORT;
 }
 
 ImageStatisticsExtensionForm::~ImageStatisticsExtensionForm()
@@ -68,6 +103,20 @@ void ImageStatisticsExtensionForm::setSettings(QVariantMap settings){
 	this->slot_setSource(settings.value(BUFFER_SRC).toInt());
 	this->slot_setBufferNr(settings.value(BUFFER_NR).toInt());
 	this->slot_setFrameNr(settings.value(FRAME_NR).toInt());
+	this->slot_setPreviewFps(settings.value(PREVIEW_FPS, DEFAULT_PREVIEW_FPS).toInt());
+	this->slot_setRefreshRate(settings.value(REFRESH_RATE, DEFAULT_REFRESH_RATE).toInt());
+	this->ui->doubleSpinBox_window->setValue(settings.value(DISPLAY_WINDOW, 0).toDouble());
+	this->ui->doubleSpinBox_level->setValue(settings.value(DISPLAY_LEVEL, 0).toDouble());
+	this->ui->doubleSpinBox_gamma->setValue(settings.value(DISPLAY_GAMMA, 1.0).toDouble());
+	this->ui->checkBox_log->setChecked(settings.value(DISPLAY_LOG, false).toBool());
+	this->slot_setDisplayMapping();
+	this->ui->lineEdit_publishAddress->setText(settings.value(PUBLISH_ADDRESS, DEFAULT_PUBLISHER_ADDRESS).toString());
+	this->ui->spinBox_publishBins->setValue(settings.value(PUBLISH_HISTOGRAM_BINS, DEFAULT_PUBLISHER_HISTOGRAM_BINS).toInt());
+	this->slot_enablePublishing(settings.value(PUBLISH_ENABLED, false).toBool());
+	this->ui->lineEdit_sharedMemoryName->setText(settings.value(SHARED_MEMORY_NAME, DEFAULT_SHARED_MEMORY_NAME).toString());
+	this->slot_enableSharedMemory(settings.value(SHARED_MEMORY_ENABLED, false).toBool());
+	this->ui->spinBox_metricsPort->setValue(settings.value(METRICS_PORT, DEFAULT_METRICS_PORT).toInt());
+	this->slot_enableMetrics(settings.value(METRICS_ENABLED, false).toBool());
 	restoreGeometry(settings.value(GEOMETRY).toByteArray());
 }
 
@@ -77,6 +126,19 @@ void ImageStatisticsExtensionForm::getSettings(QVariantMap* settings) {
 	settings->insert(BUFFER_SRC, this->parameters.bufferSrc);
 	settings->insert(BUFFER_NR,this->parameters.bufferNr);
 	settings->insert(FRAME_NR, this->parameters.frameNr);
+	settings->insert(PREVIEW_FPS, this->parameters.previewFps);
+	settings->insert(REFRESH_RATE, this->parameters.refreshRate);
+	settings->insert(DISPLAY_WINDOW, this->parameters.displayWindow);
+	settings->insert(DISPLAY_LEVEL, this->parameters.displayLevel);
+	settings->insert(DISPLAY_GAMMA, this->parameters.displayGamma);
+	settings->insert(DISPLAY_LOG, this->parameters.displayLog);
+	settings->insert(PUBLISH_ENABLED, this->parameters.publishEnabled);
+	settings->insert(PUBLISH_ADDRESS, this->parameters.publishAddress);
+	settings->insert(PUBLISH_HISTOGRAM_BINS, this->parameters.publishHistogramBins);
+	settings->insert(SHARED_MEMORY_ENABLED, this->parameters.sharedMemoryEnabled);
+	settings->insert(SHARED_MEMORY_NAME, this->parameters.sharedMemoryName);
+	settings->insert(METRICS_ENABLED, this->parameters.metricsEnabled);
+	settings->insert(METRICS_PORT, this->parameters.metricsPort);
 	settings->insert(GEOMETRY, saveGeometry());
 }
 
@@ -88,27 +150,71 @@ HistogramPlot *ImageStatisticsExtensionForm::getHistogramPlot() {
 	return this->ui->widget_histogramplot;
 }
 
-void ImageStatisticsExtensionForm::slot_updateHistogramPlot(QVector<qreal> *x, QVector<qreal> *y) {
+StripChart *ImageStatisticsExtensionForm::getStripChart() {
+	return this->ui->widget_stripchart;
+}
+
+bool ImageStatisticsExtensionForm::isPrimarySource(BUFFER_SOURCE source) {
+	//histogram and roi values are shown for processed data if both sources are active
+	if(this->parameters.bufferSrc == RAW_AND_PROCESSED){
+		return source == PROCESSED;
+	}
+	return source == this->parameters.bufferSrc;
+}
+
+void ImageStatisticsExtensionForm::updateStatisticsColumns() {
+	bool showRaw = this->parameters.bufferSrc == RAW || this->parameters.bufferSrc == RAW_AND_PROCESSED;
+	bool showProcessed = this->parameters.bufferSrc == PROCESSED || this->parameters.bufferSrc == RAW_AND_PROCESSED;
+	QList<QLabel*> rawLabels = {this->ui->label_headerRaw, this->ui->label_pixelsRaw, this->ui->label_minRaw, this->ui->label_maxRaw, this->ui->label_sumRaw, this->ui->label_averageRaw, this->ui->label_stdDeviationRaw, this->ui->label_coeffOfVariationRaw};
+	QList<QLabel*> processedLabels = {this->ui->label_headerProcessed, this->ui->label_pixels, this->ui->label_min, this->ui->label_max, this->ui->label_sum, this->ui->label_average, this->ui->label_stdDeviation, this->ui->label_coeffOfVariation};
+	for(QLabel* label : rawLabels){
+		label->setVisible(showRaw);
+	}
+	for(QLabel* label : processedLabels){
+		label->setVisible(showProcessed);
+	}
+}
+
+void ImageStatisticsExtensionForm::slot_updateHistogramPlot(BUFFER_SOURCE source, StatisticsSnapshot snapshot) {
+	//nothing is plotted while the window is hidden or minimized
+	if(!this->windowVisible || !this->isPrimarySource(source)){
+		return;
+	}
 	if(this->parameters.updateHistogramEnabled || this->updateHistogramOnce){
-		this->ui->widget_histogramplot->slot_updatePlot(x, y);
+		this->ui->widget_histogramplot->slot_updatePlot(snapshot);
 		this->updateHistogramOnce = false;
 	}
 }
 
-void ImageStatisticsExtensionForm::slot_updateStatistics(ImageStatistics* statistics) {
+void ImageStatisticsExtensionForm::slot_updateStatistics(BUFFER_SOURCE source, const ImageStatistics& statistics) {
+	if(!this->windowVisible){
+		return;
+	}
 	if(this->parameters.updateStatisticsEnabled || this->updateStatisticsOnce){
-		this->ui->label_pixels->setText(QString::number(statistics->pixels));
-		this->ui->label_sum->setText(QString::number(statistics->sum));
-		this->ui->label_average->setText(QString::number(statistics->average));
-		this->ui->label_stdDeviation->setText(QString::number(statistics->stdDeviation));
-		this->ui->label_coeffOfVariation->setText(QString::number(statistics->coeffOfVariation));
-		this->ui->label_min->setText(QString::number(statistics->min));
-		this->ui->label_max->setText(QString::number(statistics->max));
-		this->ui->label_roix->setText(QString::number(statistics->roiX));
-		this->ui->label_roiy->setText(QString::number(statistics->roiY));
-		this->ui->label_roiwidth->setText(QString::number(statistics->roiWidth));
-		this->ui->label_roiheight->setText(QString::number(statistics->roiHeight));
-		this->updateStatisticsOnce = false;
+		if(source == RAW){
+			this->ui->label_pixelsRaw->setText(QString::number(statistics.pixels));
+			this->ui->label_sumRaw->setText(QString::number(statistics.sum));
+			this->ui->label_averageRaw->setText(QString::number(statistics.average));
+			this->ui->label_stdDeviationRaw->setText(QString::number(statistics.stdDeviation));
+			this->ui->label_coeffOfVariationRaw->setText(QString::number(statistics.coeffOfVariation));
+			this->ui->label_minRaw->setText(QString::number(statistics.min));
+			this->ui->label_maxRaw->setText(QString::number(statistics.max));
+		}else{
+			this->ui->label_pixels->setText(QString::number(statistics.pixels));
+			this->ui->label_sum->setText(QString::number(statistics.sum));
+			this->ui->label_average->setText(QString::number(statistics.average));
+			this->ui->label_stdDeviation->setText(QString::number(statistics.stdDeviation));
+			this->ui->label_coeffOfVariation->setText(QString::number(statistics.coeffOfVariation));
+			this->ui->label_min->setText(QString::number(statistics.min));
+			this->ui->label_max->setText(QString::number(statistics.max));
+		}
+		if(this->isPrimarySource(source)){
+			this->ui->label_roix->setText(QString::number(statistics.roiX));
+			this->ui->label_roiy->setText(QString::number(statistics.roiY));
+			this->ui->label_roiwidth->setText(QString::number(statistics.roiWidth));
+			this->ui->label_roiheight->setText(QString::number(statistics.roiHeight));
+			this->updateStatisticsOnce = false;
+		}
 	}
 }
 
@@ -129,15 +235,18 @@ void ImageStatisticsExtensionForm::slot_enableAutoUpdateStatistics(bool enable)
 
 void ImageStatisticsExtensionForm::slot_updateHistogramPlotOnce() {
 	this->updateHistogramOnce = true;
+	emit refreshRequested();
 }
 
 void ImageStatisticsExtensionForm::slot_updateStatisticsOnce() {
 	this->updateStatisticsOnce = true;
+	emit refreshRequested();
 }
 
 void ImageStatisticsExtensionForm::slot_setSource(int index) {
 	this->parameters.bufferSrc = static_cast<BUFFER_SOURCE>(index);
 	this->ui->comboBox_source->setCurrentIndex(index);
+	this->updateStatisticsColumns();
 	emit sourceChanged(static_cast<BUFFER_SOURCE>(index));
 	emit parametersUpdated();
 }
@@ -165,6 +274,121 @@ void ImageStatisticsExtensionForm::slot_setBufferNr(int bufferNr) {
 	emit parametersUpdated();
 }
 
+void ImageStatisticsExtensionForm::slot_setPreviewFps(int fps) {
+	this->ui->spinBox_previewFps->setValue(fps);
+	this->ui->widget_roiselector->slot_setPreviewFps(fps);
+	this->parameters.previewFps = fps;
+	emit parametersUpdated();
+}
+
+void ImageStatisticsExtensionForm::slot_setRefreshRate(int fps) {
+	this->ui->spinBox_refreshRate->setValue(fps);
+	this->parameters.refreshRate = fps;
+	emit refreshRateChanged(fps);
+	emit parametersUpdated();
+}
+
+void ImageStatisticsExtensionForm::slot_setDisplayMapping() {
+	this->parameters.displayWindow = this->ui->doubleSpinBox_window->value();
+	this->parameters.displayLevel = this->ui->doubleSpinBox_level->value();
+	this->parameters.displayGamma = this->ui->doubleSpinBox_gamma->value();
+	this->parameters.displayLog = this->ui->checkBox_log->isChecked();
+	this->ui->widget_roiselector->slot_setDisplayMapping(this->parameters.displayWindow, this->parameters.displayLevel, this->parameters.displayGamma, this->parameters.displayLog);
+	emit parametersUpdated();
+}
+
+void ImageStatisticsExtensionForm::slot_record(bool start) {
+	if(!start){
+		emit recordingStopRequested();
+		return;
+	}
+	//button state is set by slot_setRecording when the recorder reports that recording started
+	this->ui->pushButton_record->setChecked(false);
+	QString fileName = QFileDialog::getSaveFileName(this, tr("Record statistics"), QString(), tr("CSV (*.csv);;Binary (*.bin)"));
+	if(!fileName.isEmpty()){
+		emit recordingStartRequested(fileName, this->ui->checkBox_recordHistograms->isChecked());
+	}
+}
+
+void ImageStatisticsExtensionForm::slot_setRecording(bool recording) {
+	this->ui->pushButton_record->setChecked(recording);
+	this->ui->pushButton_record->setText(recording ? tr("Stop recording") : tr("Record..."));
+	this->ui->checkBox_recordHistograms->setEnabled(!recording);
+}
+
+void ImageStatisticsExtensionForm::slot_capture(bool start) {
+	if(!start){
+		emit captureCancelRequested();
+		return;
+	}
+	//button state is set by slot_setCapturing when the capture file is prepared
+	this->ui->pushButton_capture->setChecked(false);
+	QString fileName = QFileDialog::getSaveFileName(this, tr("Capture frames"), QString(), tr("Frame capture (*.cap)"));
+	if(!fileName.isEmpty()){
+		emit captureRequested(fileName, this->ui->spinBox_captureFrames->value());
+	}
+}
+
+void ImageStatisticsExtensionForm::slot_setCapturing(bool capturing) {
+	this->ui->pushButton_capture->setChecked(capturing);
+	this->ui->pushButton_capture->setText(capturing ? tr("Cancel capture") : tr("Capture..."));
+	this->ui->spinBox_captureFrames->setEnabled(!capturing);
+}
+
+void ImageStatisticsExtensionForm::slot_enablePublishing(bool enable) {
+	this->parameters.publishEnabled = enable;
+	this->parameters.publishAddress = this->ui->lineEdit_publishAddress->text();
+	this->parameters.publishHistogramBins = this->ui->spinBox_publishBins->value();
+	if(enable){
+		this->ui->checkBox_publish->setChecked(false);
+		emit publishingStartRequested(this->parameters.publishAddress, this->parameters.publishHistogramBins);
+	}else{
+		emit publishingStopRequested();
+	}
+	emit parametersUpdated();
+}
+
+void ImageStatisticsExtensionForm::slot_setPublishing(bool publishing) {
+	//publishing can fail to start (e.g. port in use), the check box shows the actual state
+	this->ui->checkBox_publish->setChecked(publishing);
+	this->ui->lineEdit_publishAddress->setEnabled(!publishing);
+	this->ui->spinBox_publishBins->setEnabled(!publishing);
+}
+
+void ImageStatisticsExtensionForm::slot_enableSharedMemory(bool enable) {
+	this->parameters.sharedMemoryEnabled = enable;
+	this->parameters.sharedMemoryName = this->ui->lineEdit_sharedMemoryName->text();
+	if(enable){
+		this->ui->checkBox_sharedMemory->setChecked(false);
+		emit sharedMemoryStartRequested(this->parameters.sharedMemoryName);
+	}else{
+		emit sharedMemoryStopRequested();
+	}
+	emit parametersUpdated();
+}
+
+void ImageStatisticsExtensionForm::slot_setSharedMemory(bool exporting) {
+	this->ui->checkBox_sharedMemory->setChecked(exporting);
+	this->ui->lineEdit_sharedMemoryName->setEnabled(!exporting);
+}
+
+void ImageStatisticsExtensionForm::slot_enableMetrics(bool enable) {
+	this->parameters.metricsEnabled = enable;
+	this->parameters.metricsPort = this->ui->spinBox_metricsPort->value();
+	if(enable){
+		this->ui->checkBox_metrics->setChecked(false);
+		emit metricsStartRequested(this->parameters.metricsPort);
+	}else{
+		emit metricsStopRequested();
+	}
+	emit parametersUpdated();
+}
+
+void ImageStatisticsExtensionForm::slot_setMetrics(bool listening) {
+	this->ui->checkBox_metrics->setChecked(listening);
+	this->ui->spinBox_metricsPort->setEnabled(!listening);
+}
+
 void ImageStatisticsExtensionForm::resizeEvent(QResizeEvent *event) {
 	emit parametersUpdated();
 	QWidget::resizeEvent(event);
@@ -174,3 +398,39 @@ void ImageStatisticsExtensionForm::moveEvent(QMoveEvent *event) {
 	emit parametersUpdated();
 	QWidget::moveEvent(event);
 }
+
+void ImageStatisticsExtensionForm::showEvent(QShowEvent* event) {
+	QWidget::showEvent(event);
+	//minimizing is only reported to the top level window, which is not necessarily this widget
+	if(this->window() != this){
+		this->window()->installEventFilter(this);
+	}
+	this->updateWindowVisibility();
+}
+
+void ImageStatisticsExtensionForm::hideEvent(QHideEvent* event) {
+	QWidget::hideEvent(event);
+	this->updateWindowVisibility();
+}
+
+void ImageStatisticsExtensionForm::changeEvent(QEvent* event) {
+	QWidget::changeEvent(event);
+	if(event->type() == QEvent::WindowStateChange){
+		this->updateWindowVisibility();
+	}
+}
+
+bool ImageStatisticsExtensionForm::eventFilter(QObject* watched, QEvent* event) {
+	if(watched == this->window() && event->type() == QEvent::WindowStateChange){
+		this->updateWindowVisibility();
+	}
+	return QWidget::eventFilter(watched, event);
+}
+
+void ImageStatisticsExtensionForm::updateWindowVisibility() {
+	bool visible = this->isVisible() && !this->window()->isMinimized();
+	if(this->windowVisible != visible){
+		this->windowVisible = visible;
+		emit visibilityChanged(visible);
+	}
+}
@@ -35,16 +35,30 @@
 #define BUFFER_NR "buffer_nr"
 #define FRAME_NR "frame_nr"
 #define GEOMETRY "geometry"
+#define PREVIEW_FPS "preview_fps"
+#define REFRESH_RATE "refresh_rate"
+#define DISPLAY_WINDOW "display_window"
+#define DISPLAY_LEVEL "display_level"
+#define DISPLAY_GAMMA "display_gamma"
+#define DISPLAY_LOG "display_log"
+#define PUBLISH_ENABLED "publish_enabled"
+#define PUBLISH_ADDRESS "publish_address"
+#define PUBLISH_HISTOGRAM_BINS "publish_histogram_bins"
+#define SHARED_MEMORY_ENABLED "shared_memory_enabled"
+#define SHARED_MEMORY_NAME "shared_memory_name"
+#define METRICS_ENABLED "metrics_enabled"
+#define METRICS_PORT "metrics_port"
 
 #include <QWidget>
 #include "roiselector.h"
 #include "histogramplot.h"
+#include "stripchart.h"
 #include "imagestatisticscalculator.h"
-
-enum BUFFER_SOURCE{
-	RAW,
-	PROCESSED
-};
+#include "frameingest.h"
+#include "refreshscheduler.h"
+#include "statisticspublisher.h"
+#include "statisticssharedmemory.h"
+#include "metricsserver.h"
 
 namespace Ui {
 class ImageStatisticsExtensionForm;
@@ -57,6 +71,19 @@ struct statisticExtensionParameters {
 	BUFFER_SOURCE bufferSrc;
 	int bufferNr;
 	int frameNr;
+	int previewFps;
+	int refreshRate;
+	double displayWindow;
+	double displayLevel;
+	double displayGamma;
+	bool displayLog;
+	bool publishEnabled;
+	QString publishAddress;
+	int publishHistogramBins;
+	bool sharedMemoryEnabled;
+	QString sharedMemoryName;
+	bool metricsEnabled;
+	int metricsPort;
 };
 
 class ImageStatisticsExtensionForm : public QWidget
@@ -73,12 +100,13 @@ public:
 	Ui::ImageStatisticsExtensionForm* ui;
 	ROISelector* getROISelector();
 	HistogramPlot* getHistogramPlot();
+	StripChart* getStripChart();
 
 public slots:
-	void slot_updateStatistics(ImageStatistics* statistics);
+	void slot_updateStatistics(BUFFER_SOURCE source, const ImageStatistics& statistics);
 	void slot_enableAutoUpdateHistogram(bool enable);
 	void slot_enableAutoUpdateStatistics(bool enable);
-	void slot_updateHistogramPlot(QVector<qreal>* x, QVector<qreal>* y);
+	void slot_updateHistogramPlot(BUFFER_SOURCE source, StatisticsSnapshot snapshot);
 	void slot_updateHistogramPlotOnce();
 	void slot_updateStatisticsOnce();
 	void slot_setSource(int index);
@@ -86,20 +114,54 @@ public slots:
 	void slot_setMaximumBufferNr(int maximum);
 	void slot_setFrameNr(int frameNr);
 	void slot_setBufferNr(int bufferNr);
+	void slot_setPreviewFps(int fps);
+	void slot_setRefreshRate(int fps);
+	void slot_setDisplayMapping();
+	void slot_record(bool start);
+	void slot_setRecording(bool recording);
+	void slot_capture(bool start);
+	void slot_setCapturing(bool capturing);
+	void slot_enablePublishing(bool enable);
+	void slot_setPublishing(bool publishing);
+	void slot_enableSharedMemory(bool enable);
+	void slot_setSharedMemory(bool exporting);
+	void slot_enableMetrics(bool enable);
+	void slot_setMetrics(bool listening);
 
 private:
 	void resizeEvent(QResizeEvent* event) override;
 	void moveEvent(QMoveEvent* event) override;
+	void showEvent(QShowEvent* event) override;
+	void hideEvent(QHideEvent* event) override;
+	void changeEvent(QEvent* event) override;
+	bool eventFilter(QObject* watched, QEvent* event) override;
+	bool isPrimarySource(BUFFER_SOURCE source);
+	void updateStatisticsColumns();
+	void updateWindowVisibility();
 
 	statisticExtensionParameters parameters;
 	bool updateStatisticsOnce;
 	bool updateHistogramOnce;
+	bool windowVisible;
 
 signals:
 	void parametersUpdated();
 	void sourceChanged(BUFFER_SOURCE src);
 	void frameNrChanged(int frameNr);
 	void bufferNrChanged(int bufferNr);
+	void visibilityChanged(bool visible);
+	void refreshRateChanged(int fps);
+	void refreshRequested();
+	void recordingStartRequested(QString fileName, bool includeHistograms);
+	void recordingStopRequested();
+	void captureRequested(QString fileName, int frames);
+	void captureCancelRequested();
+	void publishingStartRequested(QString address, int histogramBins);
+	void publishingStopRequested();
+	void sharedMemoryStartRequested(QString name);
+	void sharedMemoryStopRequested();
+	void metricsStartRequested(int port);
+	void metricsStopRequested();
 
 };
 
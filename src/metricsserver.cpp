@@ -0,0 +1,215 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#include "metricsserver.h"
+#include "framebufferpool.h"
+#include <QTimer>
+
+
+MetricsServer::MetricsServer(QObject* parent) : QObject(parent)
+{
+	this->server = nullptr;
+}
+
+MetricsServer::~MetricsServer()
+{
+	this->slot_stop();
+}
+
+void MetricsServer::addSource(BUFFER_SOURCE source, const ImageStatisticsCalculator* calculator, const StatisticsMetrics* metrics) {
+	MetricsSource metricsSource;
+	metricsSource.name = source == RAW ? "raw" : "processed";
+	metricsSource.calculator = calculator;
+	metricsSource.metrics = metrics;
+	this->sources.append(metricsSource);
+}
+
+void MetricsServer::slot_start(int port) {
+	this->slot_stop();
+
+	//only local connections are accepted, remote scrapers have to go through an exporter or proxy on the rig
+	this->server = new QTcpServer(this);
+	connect(this->server, &QTcpServer::newConnection, this, &MetricsServer::slot_acceptClients);
+	if(!this->server->listen(QHostAddress::LocalHost, static_cast<quint16>(port))){
+		emit error(tr("Metrics: Could not listen on localhost port ") + QString::number(port) + ": " + this->server->errorString());
+		delete this->server;
+		this->server = nullptr;
+		emit listeningChanged(false);
+		return;
+	}
+	emit info(tr("Metrics: Serving http://localhost:") + QString::number(port) + "/metrics");
+	emit listeningChanged(true);
+}
+
+void MetricsServer::slot_stop() {
+	if(this->server == nullptr){
+		return;
+	}
+	//open connections are children of the server and are closed with it
+	delete this->server;
+	this->server = nullptr;
+	emit info(tr("Metrics: Stopped."));
+	emit listeningChanged(false);
+}
+
+void MetricsServer::slot_acceptClients() {
+	while(this->server != nullptr && this->server->hasPendingConnections()){
+		QTcpSocket* socket = this->server->nextPendingConnection();
+		connect(socket, &QTcpSocket::readyRead, this, [this, socket](){this->answerRequest(socket);});
+		connect(socket, &QTcpSocket::disconnected, socket, &QTcpSocket::deleteLater);
+		QTimer::singleShot(METRICS_REQUEST_TIMEOUT_MS, socket, &QTcpSocket::abort);
+	}
+}
+
+void MetricsServer::answerRequest(QTcpSocket* socket) {
+	//only the request line is evaluated, the response is sent when the request header is complete
+	if(socket->bytesAvailable() > METRICS_MAX_REQUEST_SIZE){
+		socket->abort();
+		return;
+	}
+	QByteArray request = socket->peek(METRICS_MAX_REQUEST_SIZE);
+	if(!request.contains("\r\n\r\n") && !request.contains("\n\n")){
+		return;
+	}
+	socket->disconnect(this);
+	QList<QByteArray> requestLine = request.left(request.indexOf('\n')).trimmed().split(' ');
+	if(requestLine.size() < 2 || (requestLine.at(0) != "GET" && requestLine.at(0) != "HEAD")){
+		this->sendResponse(socket, "405 Method Not Allowed", "text/plain", "only GET is supported\n");
+	}else if(requestLine.at(1) != "/metrics" && !requestLine.at(1).startsWith("/metrics?")){
+		this->sendResponse(socket, "404 Not Found", "text/plain", "metrics are served at /metrics\n");
+	}else{
+		QByteArray body = this->createMetrics();
+		if(requestLine.at(0) == "HEAD"){
+			body.clear();
+		}
+		this->sendResponse(socket, "200 OK", "text/plain; version=0.0.4; charset=utf-8", body);
+	}
+}
+
+void MetricsServer::sendResponse(QTcpSocket* socket, const QByteArray& status, const QByteArray& contentType, const QByteArray& body) {
+	QByteArray response = "HTTP/1.1 " + status + "\r\n";
+	response += "Content-Type: " + contentType + "\r\n";
+	response += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+	response += "Connection: close\r\n\r\n";
+	response += body;
+	socket->write(response);
+	socket->disconnectFromHost();
+}
+
+QByteArray MetricsServer::createMetrics() const {
+	QByteArray text;
+	text.reserve(8192);
+	auto addHeader = [&text](const char* name, const char* type, const char* help){
+		text += QByteArray("# HELP ") + METRICS_PREFIX + name + " " + help + "\n";
+		text += QByteArray("# TYPE ") + METRICS_PREFIX + name + " " + type + "\n";
+	};
+	auto addValue = [&text](const char* name, const QByteArray& labels, double value){
+		text += QByteArray(METRICS_PREFIX) + name + "{" + labels + "} " + QByteArray::number(value, 'g', 17) + "\n";
+	};
+	auto sourceLabel = [](const MetricsSource& source){
+		return "source=\"" + source.name + "\"";
+	};
+
+	//frame counters
+	addHeader("frames_received_total", "counter", "Buffers received from OCTproZ.");
+	for(const MetricsSource& source : this->sources){
+		addValue("frames_received_total", sourceLabel(source), static_cast<double>(source.metrics->getReceivedFrames()));
+	}
+	addHeader("frames_processed_total", "counter", "Frames for which statistics were calculated.");
+	for(const MetricsSource& source : this->sources){
+		addValue("frames_processed_total", sourceLabel(source), static_cast<double>(source.metrics->getProcessedFrames()));
+	}
+	addHeader("frames_lost_total", "counter", "Frames that were not evaluated, by the stage that discarded them.");
+	for(const MetricsSource& source : this->sources){
+		addValue("frames_lost_total", sourceLabel(source) + ",stage=\"ingest\"", static_cast<double>(source.metrics->getLostFrames()));
+		addValue("frames_lost_total", sourceLabel(source) + ",stage=\"calculation\"", static_cast<double>(source.metrics->getDroppedFrames()));
+	}
+
+	//latency quantiles are calculated from the bucket counters at scrape time
+	const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+	addHeader("latency_seconds", "summary", "Latency per processing stage.");
+	for(const MetricsSource& source : this->sources){
+		for(int stage = 0; stage < METRICS_STAGES; stage++){
+			const LatencyHistogram& latency = source.metrics->getLatency(static_cast<METRICS_STAGE>(stage));
+			QByteArray labels = sourceLabel(source) + ",stage=\"" + StatisticsMetrics::stageName(static_cast<METRICS_STAGE>(stage)) + "\"";
+			for(double q : quantiles){
+				addValue("latency_seconds", labels + ",quantile=\"" + QByteArray::number(q) + "\"", latency.quantile(q)/1000000.0);
+			}
+			addValue("latency_seconds_sum", labels, static_cast<double>(latency.getSumMicroseconds())/1000000.0);
+			addValue("latency_seconds_count", labels, static_cast<double>(latency.getCount()));
+		}
+	}
+
+	//statistics of the latest result, sources without result are omitted
+	struct RoiMetric {
+		const char* name;
+		const char* help;
+		qreal ImageStatistics::* value;
+	};
+	const RoiMetric roiMetrics[] = {
+		{"roi_min", "Minimum sample value in the roi.", &ImageStatistics::min},
+		{"roi_max", "Maximum sample value in the roi.", &ImageStatistics::max},
+		{"roi_average", "Average sample value in the roi.", &ImageStatistics::average},
+		{"roi_std_deviation", "Standard deviation of the sample values in the roi.", &ImageStatistics::stdDeviation},
+		{"roi_coeff_of_variation", "Coefficient of variation of the sample values in the roi.", &ImageStatistics::coeffOfVariation},
+		{"roi_percentile5", "5th percentile of the sample values in the roi.", &ImageStatistics::percentile5},
+		{"roi_median", "Median of the sample values in the roi.", &ImageStatistics::median},
+		{"roi_percentile95", "95th percentile of the sample values in the roi.", &ImageStatistics::percentile95}
+	};
+	QVector<StatisticsSnapshot> snapshots;
+	for(const MetricsSource& source : this->sources){
+		snapshots.append(source.calculator->getLatestSnapshot());
+	}
+	for(const RoiMetric& metric : roiMetrics){
+		addHeader(metric.name, "gauge", metric.help);
+		for(int i = 0; i < this->sources.size(); i++){
+			if(!snapshots.at(i).isNull()){
+				addValue(metric.name, sourceLabel(this->sources.at(i)), snapshots.at(i).getStatistics().*metric.value);
+			}
+		}
+	}
+	addHeader("roi_pixels", "gauge", "Number of samples in the roi.");
+	for(int i = 0; i < this->sources.size(); i++){
+		if(!snapshots.at(i).isNull()){
+			addValue("roi_pixels", sourceLabel(this->sources.at(i)), snapshots.at(i).getStatistics().pixels);
+		}
+	}
+	addHeader("last_result_timestamp_seconds", "gauge", "Time at which the frame of the latest result was received.");
+	for(int i = 0; i < this->sources.size(); i++){
+		if(!snapshots.at(i).isNull()){
+			addValue("last_result_timestamp_seconds", sourceLabel(this->sources.at(i)), static_cast<double>(snapshots.at(i).getTimestamp())/1000000.0);
+		}
+	}
+
+	//frame buffer pool is shared by both sources
+	FrameBufferPool* pool = FrameBufferPool::instance();
+	addHeader("buffer_pool_bytes", "gauge", "Memory of the frame buffer pool.");
+	addValue("buffer_pool_bytes", "state=\"total\"", static_cast<double>(pool->getTotalBytes()));
+	addValue("buffer_pool_bytes", "state=\"in_use\"", static_cast<double>(pool->getBytesInUse()));
+	return text;
+}
@@ -0,0 +1,85 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#ifndef METRICSSERVER_H
+#define METRICSSERVER_H
+
+#define METRICS_MAX_REQUEST_SIZE 8192
+#define METRICS_REQUEST_TIMEOUT_MS 5000
+#define METRICS_PREFIX "octproz_imagestatistics_"
+#define DEFAULT_METRICS_PORT 9464
+
+#include <QObject>
+#include <QVector>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include "imagestatisticscalculator.h"
+#include "statisticsmetrics.h"
+#include "frameingest.h"
+
+//MetricsServer is a minimal HTTP server on a localhost port that answers GET /metrics with the current statistics and
+//the frame, latency and memory counters in the Prometheus text format. A scrape only reads the latest published
+//statistics snapshot and pre-aggregated atomic counters, so it never waits for or slows down frame processing.
+class MetricsServer : public QObject
+{
+	Q_OBJECT
+public:
+	explicit MetricsServer(QObject* parent = nullptr);
+	~MetricsServer();
+
+	void addSource(BUFFER_SOURCE source, const ImageStatisticsCalculator* calculator, const StatisticsMetrics* metrics);
+	bool isListening() const {return this->server != nullptr;}
+
+private:
+	struct MetricsSource {
+		QByteArray name;
+		const ImageStatisticsCalculator* calculator;
+		const StatisticsMetrics* metrics;
+	};
+
+	QVector<MetricsSource> sources;
+	QTcpServer* server;
+
+	QByteArray createMetrics() const;
+	void answerRequest(QTcpSocket* socket);
+	void sendResponse(QTcpSocket* socket, const QByteArray& status, const QByteArray& contentType, const QByteArray& body);
+
+signals:
+	void listeningChanged(bool listening);
+	void info(QString);
+	void error(QString);
+
+public slots:
+	void slot_start(int port);
+	void slot_stop();
+
+private slots:
+	void slot_acceptClients();
+};
+
+#endif // METRICSSERVER_H
@@ -0,0 +1,103 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#include "previewimageitem.h"
+#include <QMutexLocker>
+
+
+PreviewImageItem::PreviewImageItem(QGraphicsItem* parent) : QGraphicsItem(parent) {
+	this->frontIndex = 0;
+	this->backBufferReady = false;
+}
+
+QRectF PreviewImageItem::boundingRect() const {
+	QMutexLocker locker(&this->mutex);
+	const QSize& size = this->sizes[this->frontIndex];
+	return QRectF(0, 0, size.width(), size.height());
+}
+
+void PreviewImageItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) {
+	Q_UNUSED(option);
+	Q_UNUSED(widget);
+	QMutexLocker locker(&this->mutex);
+	const QSize& size = this->sizes[this->frontIndex];
+	if(size.isEmpty()){
+		return;
+	}
+	//QImage only wraps the buffer, no copy is made
+	const uchar* data = this->buffers[this->frontIndex].constData();
+	QImage image(data, size.width(), size.height(), size.width(), QImage::Format_Grayscale8);
+	painter->drawImage(QPointF(0, 0), image);
+}
+
+uchar* PreviewImageItem::beginWrite(int width, int height) {
+	QMutexLocker locker(&this->mutex);
+	int backIndex = 1 - this->frontIndex;
+	this->backBufferReady = false;
+
+	//back buffer is only reallocated if the image size changes
+	int length = width*height;
+	if(this->buffers[backIndex].size() != length){
+		this->buffers[backIndex].resize(length);
+	}
+	this->sizes[backIndex] = QSize(width, height);
+	return this->buffers[backIndex].data();
+}
+
+void PreviewImageItem::endWrite() {
+	QMutexLocker locker(&this->mutex);
+	this->backBufferReady = true;
+}
+
+void PreviewImageItem::present() {
+	QMutexLocker locker(&this->mutex);
+	if(!this->backBufferReady){
+		return;
+	}
+	int backIndex = 1 - this->frontIndex;
+	bool sizeChanged = this->sizes[backIndex] != this->sizes[this->frontIndex];
+	if(sizeChanged){
+		locker.unlock(); //prepareGeometryChange calls boundingRect()
+		this->prepareGeometryChange();
+		locker.relock();
+		if(!this->backBufferReady){
+			return;
+		}
+	}
+	this->frontIndex = backIndex;
+	this->backBufferReady = false;
+	locker.unlock();
+
+	//only the area of this item is marked dirty in the scene
+	this->update();
+}
+
+QSize PreviewImageItem::getImageSize() const {
+	QMutexLocker locker(&this->mutex);
+	return this->sizes[this->frontIndex];
+}
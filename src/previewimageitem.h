@@ -0,0 +1,65 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#ifndef PREVIEWIMAGEITEM_H
+#define PREVIEWIMAGEITEM_H
+
+#include <QGraphicsItem>
+#include <QPainter>
+#include <QMutex>
+#include <QVector>
+#include <QSize>
+#include "previewsink.h"
+
+//graphics item that shows an 8 bit grayscale image from a double buffer. The converter thread writes into the back buffer,
+//the gui thread swaps buffers with present() and paints the front buffer without creating a QPixmap.
+class PreviewImageItem : public QGraphicsItem, public PreviewSink
+{
+public:
+	explicit PreviewImageItem(QGraphicsItem* parent = nullptr);
+
+	QRectF boundingRect() const override;
+	void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
+
+	//called by the converter thread
+	uchar* beginWrite(int width, int height) override;
+	void endWrite() override;
+
+	//called by the gui thread
+	void present();
+	QSize getImageSize() const;
+
+private:
+	QVector<uchar> buffers[2];
+	QSize sizes[2];
+	int frontIndex;
+	bool backBufferReady;
+	mutable QMutex mutex;
+};
+
+#endif // PREVIEWIMAGEITEM_H
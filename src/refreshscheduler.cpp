@@ -0,0 +1,75 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#include "refreshscheduler.h"
+
+
+RefreshScheduler::RefreshScheduler(QObject* parent) : QObject(parent) {
+	this->timer.setTimerType(Qt::PreciseTimer);
+	connect(&this->timer, &QTimer::timeout, this, &RefreshScheduler::tick);
+	this->setRefreshRate(DEFAULT_REFRESH_RATE);
+}
+
+void RefreshScheduler::addStatisticsSource(BUFFER_SOURCE source, ImageStatisticsCalculator* calculator) {
+	StatisticsSource statisticsSource;
+	statisticsSource.source = source;
+	statisticsSource.calculator = calculator;
+	statisticsSource.lastSequenceNumber = 0;
+	this->sources.append(statisticsSource);
+}
+
+void RefreshScheduler::setRefreshRate(int fps) {
+	this->refreshRate = qMax(1, fps);
+	this->timer.setInterval(1000/this->refreshRate);
+}
+
+void RefreshScheduler::start() {
+	this->timer.start();
+}
+
+void RefreshScheduler::stop() {
+	this->timer.stop();
+}
+
+void RefreshScheduler::invalidate() {
+	//latest results are reported again with the next tick, even if they did not change
+	for(StatisticsSource& statisticsSource : this->sources){
+		statisticsSource.lastSequenceNumber = 0;
+	}
+}
+
+void RefreshScheduler::tick() {
+	for(StatisticsSource& statisticsSource : this->sources){
+		StatisticsSnapshot snapshot = statisticsSource.calculator->getLatestSnapshot();
+		if(!snapshot.isNull() && snapshot.getSequenceNumber() != statisticsSource.lastSequenceNumber){
+			statisticsSource.lastSequenceNumber = snapshot.getSequenceNumber();
+			emit statisticsChanged(statisticsSource.source, snapshot);
+		}
+	}
+	emit refresh();
+}
@@ -0,0 +1,76 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#ifndef REFRESHSCHEDULER_H
+#define REFRESHSCHEDULER_H
+
+#define DEFAULT_REFRESH_RATE 25
+
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+#include "frameingest.h"
+#include "imagestatisticscalculator.h"
+
+//RefreshScheduler drives all gui updates from one timer on the gui thread. On every tick the latest statistics snapshot of
+//each source is pulled and only sources with new results are reported, so the gui load does not depend on the incoming frame rate.
+class RefreshScheduler : public QObject
+{
+	Q_OBJECT
+public:
+	explicit RefreshScheduler(QObject* parent = nullptr);
+
+	void addStatisticsSource(BUFFER_SOURCE source, ImageStatisticsCalculator* calculator);
+	int getRefreshRate() const {return this->refreshRate;}
+
+private:
+	struct StatisticsSource {
+		BUFFER_SOURCE source;
+		ImageStatisticsCalculator* calculator;
+		quint64 lastSequenceNumber;
+	};
+
+	QVector<StatisticsSource> sources;
+	QTimer timer;
+	int refreshRate;
+
+signals:
+	void statisticsChanged(BUFFER_SOURCE source, StatisticsSnapshot snapshot);
+	void refresh();
+
+public slots:
+	void setRefreshRate(int fps);
+	void start();
+	void stop();
+	void invalidate();
+
+private slots:
+	void tick();
+};
+
+#endif // REFRESHSCHEDULER_H
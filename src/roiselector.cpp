@@ -38,7 +38,11 @@ ROISelector::ROISelector(QWidget *parent) : QGraphicsView(parent)
 	setRenderHint(QPainter::Antialiasing);
 	setTransformationAnchor(AnchorUnderMouse);
 
-	this->inputItem = new QGraphicsPixmapItem();
+	//frameItem spans the whole acquired frame, inputItem only shows the visible part of it
+	this->frameItem = new QGraphicsRectItem();
+	this->frameItem->setPen(Qt::NoPen);
+	this->scene->addItem(this->frameItem);
+	this->inputItem = new PreviewImageItem();
 	this->scene->addItem(inputItem);
 	this->scene->update();
 
@@ -52,22 +56,35 @@ ROISelector::ROISelector(QWidget *parent) : QGraphicsView(parent)
 	this->roiRect->setPos(10, 10);
 	this->roiRectText = new QGraphicsTextItem("ROI", roiRect);
 	this->roiRectText->setFlag(QGraphicsItem::ItemIgnoresTransformations, true);
-	connect(this->roiRect, &ResizableRectItem::rectChanged, this, &ROISelector::slot_updateROI);
+	//roi changes while dragging are coalesced and emitted once per refresh tick
+	connect(this->roiRect, &ResizableRectItem::rectChanged, this, [this](){this->roiChangePending = true;});
 
 	this->frameWidth = 0;
 	this->frameHeight = 0;
+	this->previewRegion.setRect(0, 0, 0, 0);
+	this->previewDecimation = 1;
+	this->conversionInProgress = false;
+	this->roiChangePending = false;
+	this->roi.setRect(0, 0, 0, 0);
 	this->mousePosX = 0;
 	this->mousePosY = 0;
 
 	//setup bitconverter
 	this->bitConverter = new BitDepthConverter();
+	this->bitConverter->setTarget(this->inputItem);
 	this->bitConverter->moveToThread(&converterThread);
-	connect(this, &ROISelector::non8bitFrameReceived, this->bitConverter, &BitDepthConverter::convertDataTo8bit);
+	connect(this, &ROISelector::frameToConvert, this->bitConverter, &BitDepthConverter::convertDataTo8bit);
+	connect(this, &ROISelector::displayMappingChanged, this->bitConverter, &BitDepthConverter::setDisplayMapping);
 	connect(this->bitConverter, &BitDepthConverter::info, this, &ROISelector::info);
 	connect(this->bitConverter, &BitDepthConverter::error, this, &ROISelector::error);
+	connect(this->bitConverter, &BitDepthConverter::error, this, [this](){this->conversionInProgress = false;});
 	connect(this->bitConverter, &BitDepthConverter::converted8bitData, this, &ROISelector::slot_displayFrame);
 	connect(&converterThread, &QThread::finished, this->bitConverter, &BitDepthConverter::deleteLater);
 	converterThread.start();
+
+	//preview is updated on refresh ticks of the gui with its own frame rate, independent of the rate of incoming frames
+	this->slot_setPreviewFps(DEFAULT_PREVIEW_FPS);
+	this->previewTimer.start();
 }
 
 ROISelector::~ROISelector()
@@ -78,9 +95,10 @@ ROISelector::~ROISelector()
 
 void ROISelector::mouseDoubleClickEvent(QMouseEvent *event) {
 	this->fitInView(this->scene->sceneRect(), Qt::KeepAspectRatio);
-	this->ensureVisible(this->inputItem);
+	this->ensureVisible(this->frameItem);
 	this->centerOn(this->pos());
 	this->scene->setSceneRect(this->scene->itemsBoundingRect());
+	this->updatePreviewRegion();
 	QGraphicsView::mousePressEvent(event);
 }
 
@@ -129,17 +147,67 @@ void ROISelector::wheelEvent(QWheelEvent* event) {
 		QPointF deltaViewportPos = targetViewportPos - QPointF(viewport()->width() / 2.0, viewport()->height() / 2.0);
 		QPointF viewportCenter = mapFromScene(targetScenePos) - deltaViewportPos;
 		this->centerOn(mapToScene(viewportCenter.toPoint()));
+		this->updatePreviewRegion();
 		return;
 	}
 	QGraphicsView::wheelEvent(event);
 }
 
+void ROISelector::showEvent(QShowEvent* event) {
+	QGraphicsView::showEvent(event);
+	emit visibilityChanged(true);
+}
+
+void ROISelector::hideEvent(QHideEvent* event) {
+	QGraphicsView::hideEvent(event);
+	emit visibilityChanged(false);
+}
+
+void ROISelector::resizeEvent(QResizeEvent* event) {
+	QGraphicsView::resizeEvent(event);
+	emit viewportSizeChanged(this->viewport()->width(), this->viewport()->height());
+	this->updatePreviewRegion();
+}
+
+void ROISelector::scrollContentsBy(int dx, int dy) {
+	QGraphicsView::scrollContentsBy(dx, dy);
+	this->updatePreviewRegion();
+}
+
+void ROISelector::updatePreviewRegion() {
+	if(this->frameWidth == 0 || this->frameHeight == 0){
+		return;
+	}
+	//level of detail: largest power of two that is not larger than the number of frame pixels per screen pixel
+	qreal framePixelsPerScreenPixel = 1.0/qMax(this->transform().m11(), 0.000001);
+	int decimation = 1;
+	while(decimation*2 <= framePixelsPerScreenPixel){
+		decimation *= 2;
+	}
+
+	//visible scene area expanded to the tile grid of the current level of detail
+	QRectF visibleRect = this->mapToScene(this->viewport()->rect()).boundingRect();
+	int tileSize = PREVIEW_TILE_SIZE*decimation;
+	int left = qFloor(visibleRect.left()/tileSize)*tileSize;
+	int top = qFloor(visibleRect.top()/tileSize)*tileSize;
+	int right = qCeil(visibleRect.right()/tileSize)*tileSize;
+	int bottom = qCeil(visibleRect.bottom()/tileSize)*tileSize;
+	QRect region = QRect(left, top, right-left, bottom-top).intersected(QRect(0, 0, this->frameWidth, this->frameHeight));
+
+	if(region != this->previewRegion || decimation != this->previewDecimation){
+		this->previewRegion = region;
+		this->previewDecimation = decimation;
+		emit previewRegionChanged(region.x(), region.y(), region.width(), region.height(), decimation);
+	}
+}
+
 void ROISelector::scaleView(qreal scaleFactor) {
 	qreal factor = transform().scale(scaleFactor, scaleFactor).mapRect(QRectF(0, 0, 1, 1)).width();
 	if (factor < 0.07 || factor > 100){
 		return;
 	}
 	this->scale(scaleFactor, scaleFactor);
+	this->updatePreviewRegion();
 }
 
 void ROISelector::slot_zoomIn() {
@@ -150,31 +218,72 @@ void ROISelector::slot_zoomOut() {
 	this->scaleView(1/qreal(1.2));
 }
 
-void ROISelector::slot_receiveFrame(void *frame, unsigned int bitDepth, unsigned int samplesPerLine, unsigned int linesPerFrame) {
-	if(bitDepth != 8){
-		emit non8bitFrameReceived(frame, bitDepth, samplesPerLine, linesPerFrame);
-	}else{
-		this->slot_displayFrame(static_cast<uchar*>(frame), samplesPerLine, linesPerFrame);
+void ROISelector::slot_receiveFrame(FrameHandle frame) {
+	//frames that were already queued when the preview was hidden are discarded without conversion
+	if(!this->isVisible() || frame.isNull()){
+		return;
+	}
+	//only the latest frame is kept, it is converted and displayed on the next preview refresh
+	this->pendingFrame = frame;
+}
+
+void ROISelector::slot_setPreviewFps(int fps) {
+	this->previewInterval = 1000/qMax(1, fps);
+}
+
+void ROISelector::slot_refresh() {
+	if(this->roiChangePending){
+		this->slot_updateROI();
+	}
+	if(this->previewTimer.elapsed() < this->previewInterval){
+		return;
+	}
+	this->previewTimer.restart();
+	this->slot_showPendingFrame();
+}
+
+void ROISelector::slot_showPendingFrame() {
+	if(this->pendingFrame.isNull() || this->conversionInProgress){
+		return;
 	}
+	//all frames are passed to the converter, also 8 bit frames need to be mapped with the current window/level settings
+	this->conversionInProgress = true;
+	emit frameToConvert(this->pendingFrame);
+	this->pendingFrame = FrameHandle();
 }
 
-void ROISelector::slot_displayFrame(uchar* frame, unsigned int samplesPerLine, unsigned int linesPerFrame) {
-	//create QPixmap from uchar array and update inputItem
-	QImage image(frame, samplesPerLine, linesPerFrame, QImage::Format_Grayscale8 );
-	this->inputItem->setPixmap(QPixmap::fromImage(image));
+void ROISelector::slot_setDisplayMapping(double window, double level, double gamma, bool logScale) {
+	emit displayMappingChanged(window, level, gamma, logScale);
+}
+
+void ROISelector::slot_displayFrame(FrameHandle sourceFrame) {
+	this->conversionInProgress = false;
+	const FrameInfo& info = sourceFrame.getInfo();
+
+	//converter has written into the back buffer of inputItem, swapping the buffers marks only the area of inputItem as dirty. The image only contains the visible region of the frame
+	this->inputItem->present();
+
+	//decimated preview frames are scaled up and placed at their region so that scene coordinates are always frame pixel coordinates
+	this->inputItem->setScale(info.decimation);
+	this->inputItem->setPos(info.x, info.y);
 
 	//scale view if input sizes have changed
-	if(this->frameWidth != samplesPerLine || this->frameHeight != linesPerFrame){
-		this->frameWidth = samplesPerLine;
-		this->frameHeight = linesPerFrame;
-		this->fitInView(this->scene->sceneRect(), Qt::KeepAspectRatio);
-		this->ensureVisible(this->inputItem);
-		this->centerOn(this->pos());
+	int frameWidth = static_cast<int>(info.frameWidth);
+	int frameHeight = static_cast<int>(info.frameHeight);
+	if(this->frameWidth != frameWidth || this->frameHeight != frameHeight){
+		this->frameWidth = frameWidth;
+		this->frameHeight = frameHeight;
+		this->frameItem->setRect(0, 0, frameWidth, frameHeight);
 
-		//set scene rect back to minimal size
+		//set scene rect to minimal size
 		this->scene->setSceneRect(this->scene->itemsBoundingRect());
 
+		this->fitInView(this->scene->sceneRect(), Qt::KeepAspectRatio);
+		this->ensureVisible(this->frameItem);
+		this->centerOn(this->pos());
+
 		this->slot_updateROI();
+		this->updatePreviewRegion();
 	}
 }
 
@@ -185,7 +294,7 @@ void ROISelector::slot_updateROI() {
 	qreal width = this->roiRect->getInnerRectWidth();
 	qreal height = this->roiRect->getInnerRectHeight();
 
-	QRectF frameRect = this->inputItem->boundingRect();
+	QRectF frameRect = this->frameItem->rect();
 	// qreal xposFrame = this->inputItem->x();
 	// qreal yposFrame = this->inputItem->y();
 	// qreal widthFrame = frameRect.width();
@@ -196,5 +305,10 @@ void ROISelector::slot_updateROI() {
 	// qreal widthdelta = frameRect.width() - width;
 	// qreal heightdelta = frameRect.height() - height;
 
-	emit roiChanged(static_cast<int>(-roiX), static_cast<int>(-roiY), static_cast<int>(width), static_cast<int>(height));
+	this->roiChangePending = false;
+	QRect roi(static_cast<int>(-roiX), static_cast<int>(-roiY), static_cast<int>(width), static_cast<int>(height));
+	if(roi != this->roi){
+		this->roi = roi;
+		emit roiChanged(roi.x(), roi.y(), roi.width(), roi.height());
+	}
 }
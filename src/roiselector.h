@@ -28,14 +28,19 @@
 #ifndef ROISELECTOR_H
 #define ROISELECTOR_H
 
+#define DEFAULT_PREVIEW_FPS 15
+#define PREVIEW_TILE_SIZE 256 //preview region is aligned to a grid of tiles of PREVIEW_TILE_SIZE*decimation frame pixels, i.e. PREVIEW_TILE_SIZE decimated preview pixels
+
 #include <QWidget>
 #include <QGraphicsView>
-#include <QGraphicsPixmapItem>
+#include <QGraphicsRectItem>
 #include <QThread>
+#include <QElapsedTimer>
 #include <QKeyEvent>
 #include <QWheelEvent>
 #include <QtMath>
 #include "bitdepthconverter.h"
+#include "previewimageitem.h"
 #include "resizablerectitem.h"
 #include "resizablerectitemsettings.h"
 
@@ -54,33 +59,55 @@ private:
 	void mouseMoveEvent(QMouseEvent* event) override;
 	void keyPressEvent(QKeyEvent* event) override;
 	void wheelEvent(QWheelEvent* event) override;
+	void showEvent(QShowEvent* event) override;
+	void hideEvent(QHideEvent* event) override;
+	void resizeEvent(QResizeEvent* event) override;
+	void scrollContentsBy(int dx, int dy) override;
 	void scaleView(qreal scaleFactor);
+	void updatePreviewRegion();
 
 
 
 private:
 	BitDepthConverter* bitConverter;
 	QGraphicsScene* scene;
-	QGraphicsPixmapItem* inputItem;
+	PreviewImageItem* inputItem;
+	QGraphicsRectItem* frameItem;
 	ResizableRectItem* roiRect;
 	ResizableRectItemSettings* roiRectSettings;
 	QGraphicsTextItem* roiRectText;
 	int frameWidth;
 	int frameHeight;
+	QRect previewRegion;
+	int previewDecimation;
+	QElapsedTimer previewTimer;
+	int previewInterval;
+	FrameHandle pendingFrame;
+	bool conversionInProgress;
+	bool roiChangePending;
+	QRect roi;
 	int mousePosX;
 	int mousePosY;
 
 signals:
 	void roiChanged(int x, int y, int width, int height);
-	void non8bitFrameReceived(void *frame, unsigned int bitDepth, unsigned int samplesPerLine, unsigned int linesPerFrame);
+	void frameToConvert(FrameHandle frame);
+	void displayMappingChanged(double window, double level, double gamma, bool logScale);
+	void visibilityChanged(bool visible);
+	void viewportSizeChanged(int width, int height);
+	void previewRegionChanged(int x, int y, int width, int height, int decimation);
 	void info(QString);
 	void error(QString);
 
 public slots:
 	void slot_zoomIn();
 	void slot_zoomOut();
-	void slot_receiveFrame(void* frame, unsigned int bitDepth, unsigned int samplesPerLine, unsigned int linesPerFrame);
-	void slot_displayFrame(uchar* frame, unsigned int samplesPerLine, unsigned int linesPerFrame);
+	void slot_receiveFrame(FrameHandle frame);
+	void slot_setPreviewFps(int fps);
+	void slot_setDisplayMapping(double window, double level, double gamma, bool logScale);
+	void slot_showPendingFrame();
+	void slot_refresh();
+	void slot_displayFrame(FrameHandle sourceFrame);
 	void slot_updateROI();
 };
 
@@ -0,0 +1,224 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#include "statisticspublisher.h"
+#include <QDataStream>
+#include <QMutexLocker>
+#include <QTcpSocket>
+#include <QLocalSocket>
+
+
+StatisticsPublisher::StatisticsPublisher(QObject* parent) : QObject(parent)
+{
+	this->publishing.storeRelaxed(0);
+	this->histogramBins.storeRelaxed(0);
+	this->droppedMessages.storeRelaxed(0);
+	this->tcpServer = nullptr;
+	this->localServer = nullptr;
+	this->queuedMessages.reserve(PUBLISHER_QUEUE_CAPACITY);
+	this->sendMessages.reserve(PUBLISHER_QUEUE_CAPACITY);
+}
+
+StatisticsPublisher::~StatisticsPublisher()
+{
+	this->slot_stop();
+}
+
+void StatisticsPublisher::record(BUFFER_SOURCE source, const StatisticsSnapshotData* snapshot) {
+	if(!this->isPublishing()){
+		return;
+	}
+	//histogram is downsampled by summing neighboring bins, so a message stays small also for 16 bit data
+	int inputBins = snapshot->histogram.size();
+	int valuesPerBin = 1;
+	int numberOfBins = StatisticsKernel::downsampledBins(inputBins, this->histogramBins.loadAcquire(), &valuesPerBin);
+
+	bool wasEmpty = false;
+	{
+		QMutexLocker locker(&this->queueMutex);
+		if(this->queuedMessages.size() >= PUBLISHER_QUEUE_CAPACITY){
+			this->droppedMessages.fetchAndAddRelaxed(1);
+			return;
+		}
+		wasEmpty = this->queuedMessages.isEmpty();
+		Message message;
+		message.source = source;
+		message.sequenceNumber = snapshot->sequenceNumber;
+		message.frameSequenceNumber = snapshot->frameSequenceNumber;
+		message.timestamp = snapshot->timestamp;
+		message.statistics = snapshot->statistics;
+		message.valuesPerBin = valuesPerBin;
+		message.firstBin = this->queuedBins.size();
+		message.numberOfBins = numberOfBins;
+		this->queuedMessages.append(message);
+		this->queuedBins.resize(message.firstBin+numberOfBins);
+		StatisticsKernel::downsampleHistogram(snapshot->histogram.constData(), inputBins, valuesPerBin, numberOfBins, this->queuedBins.data()+message.firstBin);
+	}
+
+	//the publisher thread is only woken up for the first message of a batch
+	if(wasEmpty){
+		QMetaObject::invokeMethod(this, "slot_send", Qt::QueuedConnection);
+	}
+}
+
+void StatisticsPublisher::slot_start(QString address, int histogramBins) {
+	this->slot_stop();
+
+	//only local connections are accepted
+	bool listening = false;
+	if(address.startsWith("tcp:")){
+		this->tcpServer = new QTcpServer(this);
+		connect(this->tcpServer, &QTcpServer::newConnection, this, &StatisticsPublisher::slot_acceptClients);
+		listening = this->tcpServer->listen(QHostAddress::LocalHost, static_cast<quint16>(address.mid(4).toUInt()));
+	}else if(address.startsWith("local:")){
+		QString name = address.mid(6);
+		this->localServer = new QLocalServer(this);
+		connect(this->localServer, &QLocalServer::newConnection, this, &StatisticsPublisher::slot_acceptClients);
+		QLocalServer::removeServer(name);
+		listening = this->localServer->listen(name);
+	}
+	if(!listening){
+		emit error(tr("Publisher: Could not listen on \"") + address + tr("\". Use tcp:<port> or local:<name>."));
+		this->slot_stop();
+		return;
+	}
+
+	int bins = qBound(0, histogramBins, PUBLISHER_MAX_HISTOGRAM_BINS);
+	this->histogramBins.storeRelease(bins);
+	{
+		//a producer that saw the previous publishing state may still be appending
+		QMutexLocker locker(&this->queueMutex);
+		this->queuedBins.reserve(PUBLISHER_QUEUE_CAPACITY*bins);
+	}
+	this->sendBins.reserve(PUBLISHER_QUEUE_CAPACITY*bins);
+	this->droppedMessages.storeRelaxed(0);
+	this->publishing.storeRelease(1);
+	emit info(tr("Publisher: Publishing statistics on ") + address);
+	emit publishingChanged(true);
+}
+
+void StatisticsPublisher::slot_stop() {
+	bool wasPublishing = this->publishing.fetchAndStoreOrdered(0) != 0;
+	const QList<QIODevice*> clients = this->clients;
+	for(QIODevice* client : clients){
+		this->removeClient(client);
+	}
+	delete this->tcpServer;
+	this->tcpServer = nullptr;
+	delete this->localServer;
+	this->localServer = nullptr;
+	if(wasPublishing){
+		emit info(tr("Publisher: Publishing stopped. Dropped messages: ") + QString::number(this->droppedMessages.loadAcquire()));
+		emit publishingChanged(false);
+	}
+}
+
+void StatisticsPublisher::slot_acceptClients() {
+	while(this->tcpServer != nullptr && this->tcpServer->hasPendingConnections()){
+		this->addClient(this->tcpServer->nextPendingConnection());
+	}
+	while(this->localServer != nullptr && this->localServer->hasPendingConnections()){
+		this->addClient(this->localServer->nextPendingConnection());
+	}
+}
+
+void StatisticsPublisher::addClient(QIODevice* client) {
+	this->clients.append(client);
+	QTcpSocket* tcpSocket = qobject_cast<QTcpSocket*>(client);
+	if(tcpSocket != nullptr){
+		connect(tcpSocket, &QTcpSocket::disconnected, this, [this, client](){this->removeClient(client);});
+	}
+	QLocalSocket* localSocket = qobject_cast<QLocalSocket*>(client);
+	if(localSocket != nullptr){
+		connect(localSocket, &QLocalSocket::disconnected, this, [this, client](){this->removeClient(client);});
+	}
+	emit info(tr("Publisher: Client connected. Clients: ") + QString::number(this->clients.size()));
+}
+
+void StatisticsPublisher::removeClient(QIODevice* client) {
+	if(this->clients.removeOne(client)){
+		//unsent data is discarded
+		client->disconnect(this);
+		QTcpSocket* tcpSocket = qobject_cast<QTcpSocket*>(client);
+		if(tcpSocket != nullptr){
+			tcpSocket->abort();
+		}
+		QLocalSocket* localSocket = qobject_cast<QLocalSocket*>(client);
+		if(localSocket != nullptr){
+			localSocket->abort();
+		}
+		client->deleteLater();
+		emit info(tr("Publisher: Client disconnected. Clients: ") + QString::number(this->clients.size()));
+	}
+}
+
+void StatisticsPublisher::slot_send() {
+	//send queues are empty and have the same capacity as the queues of the producers, so swapping does not allocate
+	this->sendMessages.clear();
+	this->sendBins.clear();
+	{
+		QMutexLocker locker(&this->queueMutex);
+		this->queuedMessages.swap(this->sendMessages);
+		this->queuedBins.swap(this->sendBins);
+	}
+	if(this->sendMessages.isEmpty() || this->clients.isEmpty()){
+		return;
+	}
+	this->encodeMessages();
+
+	//sockets buffer unsent data. a client that falls behind is disconnected instead of letting the buffer grow. only data
+	//left over from earlier batches counts, so a single large batch does not disconnect a client that keeps up
+	const QList<QIODevice*> clients = this->clients;
+	for(QIODevice* client : clients){
+		if(client->bytesToWrite() > PUBLISHER_MAX_CLIENT_BACKLOG){
+			emit info(tr("Publisher: Client does not read fast enough and is disconnected."));
+			this->removeClient(client);
+			continue;
+		}
+		client->write(this->sendBuffer);
+	}
+}
+
+void StatisticsPublisher::encodeMessages() {
+	this->sendBuffer.clear();
+	QDataStream stream(&this->sendBuffer, QIODevice::WriteOnly);
+	stream.setByteOrder(QDataStream::LittleEndian);
+	stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+	for(const Message& message : qAsConst(this->sendMessages)){
+		const ImageStatistics& s = message.statistics;
+		quint32 payloadSize = 1 + 3*8 + 4 + 9*8 + 4*4 + 2*4 + 4*static_cast<quint32>(message.numberOfBins);
+		stream << static_cast<quint32>(PUBLISHER_MAGIC) << static_cast<quint16>(PUBLISHER_VERSION) << static_cast<quint16>(PUBLISHER_MESSAGE_STATISTICS) << payloadSize;
+		stream << static_cast<quint8>(message.source) << message.sequenceNumber << message.frameSequenceNumber << message.timestamp;
+		stream << static_cast<qint32>(s.pixels) << s.min << s.max << s.sum << s.average << s.stdDeviation << s.coeffOfVariation << s.percentile5 << s.median << s.percentile95;
+		stream << static_cast<qint32>(s.roiX) << static_cast<qint32>(s.roiY) << static_cast<qint32>(s.roiWidth) << static_cast<qint32>(s.roiHeight);
+		stream << static_cast<quint32>(message.valuesPerBin) << static_cast<quint32>(message.numberOfBins);
+		for(int i = 0; i < message.numberOfBins; i++){
+			stream << this->sendBins[message.firstBin+i];
+		}
+	}
+}
@@ -0,0 +1,116 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#ifndef STATISTICSPUBLISHER_H
+#define STATISTICSPUBLISHER_H
+
+#define PUBLISHER_QUEUE_CAPACITY 256 //maximum number of messages waiting for the publisher thread
+#define PUBLISHER_MAX_HISTOGRAM_BINS 4096
+#define PUBLISHER_MAX_CLIENT_BACKLOG 1048576 //clients with more unsent bytes from earlier batches than this are disconnected
+#define PUBLISHER_MAGIC 0x42505349 //"ISPB" in little endian byte order
+#define PUBLISHER_VERSION 1
+#define PUBLISHER_MESSAGE_STATISTICS 1
+#define DEFAULT_PUBLISHER_ADDRESS "tcp:5555"
+#define DEFAULT_PUBLISHER_HISTOGRAM_BINS 256
+
+#include <QObject>
+#include <QMutex>
+#include <QVector>
+#include <QList>
+#include <QAtomicInt>
+#include <QAtomicInteger>
+#include <QTcpServer>
+#include <QLocalServer>
+#include "statisticssink.h"
+#include "statisticskernel.h"
+
+//StatisticsPublisher sends every statistics result, and optionally a downsampled histogram, to all clients connected to a
+//localhost tcp port ("tcp:<port>") or a local socket ("local:<name>"). Calculator threads only append messages to a bounded
+//queue, sockets are written by the thread of the publisher. Clients that do not read fast enough are disconnected.
+//
+//every message is little endian and starts with a header:
+//	quint32 magic, quint16 version, quint16 type, quint32 payload size in bytes
+//payload of PUBLISHER_MESSAGE_STATISTICS:
+//	quint8 source (0 raw, 1 processed), quint64 sequence nr, quint64 frame sequence nr, qint64 timestamp (us since epoch),
+//	qint32 pixels, double min, max, sum, average, std deviation, coeff of variation, 5th percentile, median, 95th percentile,
+//	qint32 roi x, roi y, roi width, roi height, quint32 values per histogram bin, quint32 number of bins, quint32 bins[number of bins]
+class StatisticsPublisher : public QObject, public StatisticsSink
+{
+	Q_OBJECT
+public:
+	explicit StatisticsPublisher(QObject* parent = nullptr);
+	~StatisticsPublisher();
+
+	void record(BUFFER_SOURCE source, const StatisticsSnapshotData* snapshot) override;
+	bool isPublishing() const {return this->publishing.loadAcquire() != 0;}
+
+private:
+	struct Message {
+		BUFFER_SOURCE source;
+		quint64 sequenceNumber;
+		quint64 frameSequenceNumber;
+		qint64 timestamp;
+		ImageStatistics statistics;
+		int valuesPerBin;
+		int firstBin; //index into queued bins
+		int numberOfBins;
+	};
+
+	QMutex queueMutex;
+	QVector<Message> queuedMessages;
+	QVector<quint32> queuedBins;
+	QVector<Message> sendMessages; //only used by publisher thread
+	QVector<quint32> sendBins;
+	QByteArray sendBuffer;
+
+	QAtomicInt publishing;
+	QAtomicInt histogramBins;
+	QAtomicInteger<quint64> droppedMessages;
+	QTcpServer* tcpServer;
+	QLocalServer* localServer;
+	QList<QIODevice*> clients;
+
+	void encodeMessages();
+	void addClient(QIODevice* client);
+	void removeClient(QIODevice* client);
+
+signals:
+	void publishingChanged(bool publishing);
+	void info(QString);
+	void error(QString);
+
+public slots:
+	void slot_start(QString address, int histogramBins);
+	void slot_stop();
+
+private slots:
+	void slot_send();
+	void slot_acceptClients();
+};
+
+#endif // STATISTICSPUBLISHER_H
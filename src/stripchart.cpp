@@ -0,0 +1,143 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#include "stripchart.h"
+#include <cmath>
+
+
+StripChart::StripChart(QWidget* parent) : QCustomPlot(parent)
+{
+	//configure appearance of plot area similar to histogram plot
+	this->setBackground(QColor(50, 50, 50));
+	this->axisRect()->setBackground(QColor(25, 25, 25));
+	this->setAxisColor(QColor(200, 200, 200));
+	QSharedPointer<QCPAxisTickerDateTime> timeTicker(new QCPAxisTickerDateTime);
+	timeTicker->setDateTimeFormat("hh:mm:ss");
+	this->xAxis->setTicker(timeTicker);
+
+	//min and max of every pixel column are connected by one line, so the graph shows the full range of values of each column
+	this->graph = this->addGraph();
+	this->graph->setPen(QPen(QColor(200, 200, 200)));
+	this->graph->setAdaptiveSampling(false);
+
+	this->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);
+	this->axisRect()->setRangeDrag(Qt::Horizontal);
+	this->axisRect()->setRangeZoom(Qt::Horizontal);
+	connect(this->xAxis, QOverload<const QCPRange&>::of(&QCPAxis::rangeChanged), this, [this](){this->rangeChanged = true;});
+
+	this->history = nullptr;
+	this->value = HISTORY_MEAN;
+	this->followLatest = true;
+	this->rangeChanged = false;
+	this->lastRevision = 0;
+}
+
+void StripChart::setHistory(const StatisticsHistory* history) {
+	this->history = history;
+	this->lastRevision = 0;
+	this->rangeChanged = true;
+	this->graph->data()->clear();
+	this->replot();
+}
+
+void StripChart::setValue(HISTORY_VALUE value) {
+	this->value = value;
+	this->rangeChanged = true;
+}
+
+void StripChart::setAxisColor(QColor color) {
+	this->xAxis->setBasePen(QPen(color, 1));
+	this->yAxis->setBasePen(QPen(color, 1));
+	this->xAxis->setTickPen(QPen(color, 1));
+	this->yAxis->setTickPen(QPen(color, 1));
+	this->xAxis->setSubTickPen(QPen(color, 1));
+	this->yAxis->setSubTickPen(QPen(color, 1));
+	this->xAxis->setTickLabelColor(color);
+	this->yAxis->setTickLabelColor(color);
+}
+
+void StripChart::mousePressEvent(QMouseEvent* event) {
+	//time range is not moved with new samples anymore as soon as the user navigates in the chart
+	this->followLatest = false;
+	QCustomPlot::mousePressEvent(event);
+}
+
+void StripChart::wheelEvent(QWheelEvent* event) {
+	this->followLatest = false;
+	QCustomPlot::wheelEvent(event);
+}
+
+void StripChart::mouseDoubleClickEvent(QMouseEvent* event) {
+	this->followLatest = true;
+	this->rangeChanged = true;
+	this->slot_refresh();
+	QCustomPlot::mouseDoubleClickEvent(event);
+}
+
+void StripChart::slot_refresh() {
+	if(this->history == nullptr || !this->isVisible()){
+		return;
+	}
+	quint64 revision = this->history->getRevision();
+	if(revision == this->lastRevision && !this->rangeChanged){
+		return;
+	}
+	this->lastRevision = revision;
+
+	qint64 firstTimestamp = 0;
+	qint64 lastTimestamp = 0;
+	if(!this->history->getTimeRange(&firstTimestamp, &lastTimestamp)){
+		this->graph->data()->clear();
+		this->replot();
+		this->rangeChanged = false;
+		return;
+	}
+
+	//keys are seconds since epoch, timestamps of the history are microseconds since epoch
+	if(this->followLatest){
+		this->xAxis->setRange(firstTimestamp/1000000.0, qMax(lastTimestamp, firstTimestamp+1000000)/1000000.0);
+	}
+	QCPRange range = this->xAxis->range();
+	int columns = qMax(1, this->axisRect()->width());
+	this->history->decimate(this->value, static_cast<qint64>(range.lower*1000000.0), static_cast<qint64>(range.upper*1000000.0), columns, &this->minValues, &this->maxValues);
+
+	//two points per column, empty columns interrupt the line
+	double columnWidth = range.size()/columns;
+	this->graphData.resize(2*columns);
+	for(int column = 0; column < columns; column++){
+		double key = range.lower + (column + 0.5)*columnWidth;
+		this->graphData[2*column] = QCPGraphData(key, this->minValues[column]);
+		this->graphData[2*column+1] = QCPGraphData(key, this->maxValues[column]);
+	}
+	this->graph->data()->set(this->graphData, true);
+	if(this->followLatest){
+		this->graph->rescaleValueAxis(false, true);
+	}
+	this->replot();
+	this->rangeChanged = false;
+}
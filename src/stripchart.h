@@ -0,0 +1,68 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#ifndef STRIPCHART_H
+#define STRIPCHART_H
+
+#include "qcustomplot.h"
+#include "statisticshistory.h"
+
+//StripChart plots one value of a StatisticsHistory over time. The history is decimated to min/max per pixel column of the
+//visible time range, so drawing time does not depend on the length of the history.
+class StripChart : public QCustomPlot
+{
+	Q_OBJECT
+public:
+	explicit StripChart(QWidget* parent = nullptr);
+
+	void setHistory(const StatisticsHistory* history);
+	void setValue(HISTORY_VALUE value);
+
+private:
+	const StatisticsHistory* history;
+	HISTORY_VALUE value;
+	QCPGraph* graph;
+	bool followLatest;
+	bool rangeChanged;
+	quint64 lastRevision;
+	QVector<float> minValues;
+	QVector<float> maxValues;
+	QVector<QCPGraphData> graphData;
+
+	void setAxisColor(QColor color);
+
+protected:
+	void mousePressEvent(QMouseEvent* event) override;
+	void wheelEvent(QWheelEvent* event) override;
+	void mouseDoubleClickEvent(QMouseEvent* event) override;
+
+public slots:
+	void slot_refresh();
+};
+
+#endif // STRIPCHART_H
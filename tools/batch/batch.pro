@@ -0,0 +1,21 @@
+QT	   = core
+CONFIG += console
+CONFIG -= app_bundle
+
+TARGET = imagestatistics-batch
+TEMPLATE = app
+
+DEFINES += \
+	QT_DEPRECATED_WARNINGS #emit warnings if depracted Qt features are used
+
+SOURCES += \
+	main.cpp \
+	batchprocessor.cpp \
+	workstealingscheduler.cpp
+
+HEADERS += \
+	batchprocessor.h \
+	workstealingscheduler.h
+
+#statistics are calculated by the same kernel as in the plugin
+include(../../src/core/imagestatisticscore.pri)
@@ -0,0 +1,468 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#include "batchprocessor.h"
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QtMath>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+
+
+static const char* metricNames[] = {"pixels", "min", "max", "sum", "mean", "std", "cv", "p5", "median", "p95"};
+
+
+StatisticsAccumulator::StatisticsAccumulator()
+{
+	this->frames = 0;
+	this->pixels = 0;
+	this->sum = 0;
+	this->squaredDeviations = 0;
+	this->min = 0;
+	this->max = 0;
+}
+
+void StatisticsAccumulator::combine(quint64 otherPixels, qreal otherSum, qreal otherSquaredDeviations) {
+	if(this->pixels == 0){
+		this->pixels = otherPixels;
+		this->sum = otherSum;
+		this->squaredDeviations = otherSquaredDeviations;
+		return;
+	}
+	qreal delta = otherSum/otherPixels - this->sum/this->pixels;
+	quint64 combinedPixels = this->pixels + otherPixels;
+	this->squaredDeviations += otherSquaredDeviations + delta*delta*(static_cast<qreal>(this->pixels)*otherPixels/combinedPixels);
+	this->pixels = combinedPixels;
+	this->sum += otherSum;
+}
+
+void StatisticsAccumulator::add(const ImageStatistics& statistics, const QVector<quint32>& histogram) {
+	if(statistics.pixels <= 0){
+		return;
+	}
+	this->min = this->isEmpty() ? statistics.min : qMin(this->min, statistics.min);
+	this->max = this->isEmpty() ? statistics.max : qMax(this->max, statistics.max);
+	this->combine(static_cast<quint64>(statistics.pixels), statistics.sum, statistics.stdDeviation*statistics.stdDeviation*statistics.pixels);
+	if(this->histogram.size() != histogram.size()){
+		this->histogram.fill(0, histogram.size());
+	}
+	//volume histograms count up to 2^32-1 samples per bin
+	for(int i = 0; i < histogram.size(); i++){
+		this->histogram[i] += histogram.at(i);
+	}
+	this->frames++;
+}
+
+void StatisticsAccumulator::merge(const StatisticsAccumulator& other) {
+	if(other.isEmpty()){
+		return;
+	}
+	this->min = this->isEmpty() ? other.min : qMin(this->min, other.min);
+	this->max = this->isEmpty() ? other.max : qMax(this->max, other.max);
+	this->combine(other.pixels, other.sum, other.squaredDeviations);
+	if(this->histogram.size() != other.histogram.size()){
+		this->histogram.fill(0, other.histogram.size());
+	}
+	for(int i = 0; i < other.histogram.size(); i++){
+		this->histogram[i] += other.histogram.at(i);
+	}
+	this->frames += other.frames;
+}
+
+ImageStatistics StatisticsAccumulator::getStatistics() const {
+	ImageStatistics statistics = {};
+	statistics.pixels = static_cast<int>(qMin<quint64>(this->pixels, INT_MAX));
+	statistics.min = this->min;
+	statistics.max = this->max;
+	statistics.sum = this->sum;
+	statistics.average = this->sum/this->pixels;
+	statistics.stdDeviation = qSqrt(this->squaredDeviations/this->pixels);
+	statistics.coeffOfVariation = statistics.stdDeviation/statistics.average;
+	StatisticsKernel::percentilesFromHistogram(this->histogram.constData(), this->histogram.size(), this->pixels, &statistics);
+	return statistics;
+}
+
+
+BatchProcessor::BatchProcessor(QObject* parent) : QObject(parent)
+{
+	this->maskWidth = 0;
+	this->maskHeight = 0;
+	this->skippedFiles = 0;
+}
+
+BatchProcessor::~BatchProcessor()
+{
+	for(BatchFile* file : qAsConst(this->files)){
+		delete file->recording;
+	}
+	qDeleteAll(this->files);
+	for(const QVector<Volume*>& fileVolumes : qAsConst(this->volumes)){
+		qDeleteAll(fileVolumes);
+	}
+}
+
+bool BatchProcessor::parseMetrics(const QString& text, QList<BATCH_METRIC>* metrics) {
+	metrics->clear();
+	int numberOfMetrics = static_cast<int>(sizeof(metricNames)/sizeof(metricNames[0]));
+	for(const QString& name : text.split(',', Qt::SkipEmptyParts)){
+		QString metricName = name.trimmed().toLower();
+		if(metricName == "all"){
+			for(int i = 0; i < numberOfMetrics; i++){
+				metrics->append(static_cast<BATCH_METRIC>(i));
+			}
+			continue;
+		}
+		int index = -1;
+		for(int i = 0; i < numberOfMetrics; i++){
+			if(metricName == metricNames[i]){
+				index = i;
+			}
+		}
+		if(index < 0){
+			return false;
+		}
+		metrics->append(static_cast<BATCH_METRIC>(index));
+	}
+	return !metrics->isEmpty();
+}
+
+bool BatchProcessor::readMask(const QString& fileName) {
+	//binary 8 bit pgm: "P5", width, height, maximum value, each separated by whitespace, comments start with #
+	QFile file(fileName);
+	if(!file.open(QIODevice::ReadOnly)){
+		emit error(tr("Could not open mask ") + fileName);
+		return false;
+	}
+	QByteArray data = file.readAll();
+	int position = 0;
+	QList<int> values;
+	QByteArray magic;
+	while(values.size() < 3 && position < data.size()){
+		char c = data.at(position);
+		if(c == '#'){
+			while(position < data.size() && data.at(position) != '\n'){position++;}
+		}else if(QChar(c).isSpace()){
+			position++;
+		}else{
+			int start = position;
+			while(position < data.size() && !QChar(data.at(position)).isSpace()){position++;}
+			QByteArray token = data.mid(start, position-start);
+			if(magic.isEmpty()){
+				magic = token;
+			}else{
+				values.append(token.toInt());
+			}
+		}
+	}
+	position++; //single whitespace after maximum value
+	if(magic != "P5" || values.size() != 3 || values.at(0) <= 0 || values.at(1) <= 0 || values.at(2) > 255 || data.size()-position < values.at(0)*values.at(1)){
+		emit error(tr("Mask is not a binary 8 bit pgm file: ") + fileName);
+		return false;
+	}
+	this->maskWidth = values.at(0);
+	this->maskHeight = values.at(1);
+	this->mask.resize(this->maskWidth*this->maskHeight);
+	memcpy(this->mask.data(), data.constData()+position, static_cast<size_t>(this->mask.size()));
+	return true;
+}
+
+bool BatchProcessor::open(const BatchParameters& parameters) {
+	this->parameters = parameters;
+	if(!parameters.maskFile.isEmpty() && !this->readMask(parameters.maskFile)){
+		return false;
+	}
+
+	//files that can not be read are reported and counted, the remaining files are processed
+	QDir directory(parameters.directory);
+	QStringList entries = directory.entryList(parameters.nameFilters, QDir::Files, QDir::Name);
+	for(const QString& entry : qAsConst(entries)){
+		BatchFile* file = new BatchFile();
+		file->name = entry;
+		file->path = directory.filePath(entry);
+		file->recording = nullptr;
+		file->remainingTasks = 0;
+		file->failed = false;
+		if(!this->probeFile(file)){
+			emit error(file->errorString);
+			this->skippedFiles++;
+			delete file;
+			continue;
+		}
+		this->files.append(file);
+	}
+	if(this->files.isEmpty()){
+		emit error(tr("No recordings found in ") + parameters.directory);
+		return false;
+	}
+
+	//results are stored per frame or per volume and written in order when all tasks are done
+	for(const BatchFile* file : qAsConst(this->files)){
+		if(this->parameters.perVolume){
+			quint64 numberOfVolumes = this->parameters.framesPerVolume == 0 ? 1 : (file->numberOfFrames+this->parameters.framesPerVolume-1)/this->parameters.framesPerVolume;
+			QVector<Volume*> fileVolumes;
+			for(quint64 i = 0; i < numberOfVolumes; i++){
+				fileVolumes.append(new Volume());
+			}
+			this->volumes.append(fileVolumes);
+			this->frameResults.append(QVector<FrameResult>());
+		}else{
+			this->frameResults.append(QVector<FrameResult>(static_cast<int>(file->numberOfFrames)));
+			this->volumes.append(QVector<Volume*>());
+		}
+	}
+	return true;
+}
+
+bool BatchProcessor::probeFile(BatchFile* file) {
+	//the dimensions are read once here, the file is closed again until a worker processes it
+	RecordingFile recording;
+	if(!recording.open(file->path, this->parameters.bitDepth, this->parameters.samplesPerLine, this->parameters.linesPerFrame, PROCESSED)){
+		file->errorString = recording.getErrorString();
+		return false;
+	}
+	if(!this->mask.isEmpty() && (recording.getSamplesPerLine() != static_cast<unsigned int>(this->maskWidth) || recording.getLinesPerFrame() != static_cast<unsigned int>(this->maskHeight))){
+		file->errorString = tr("Mask size does not match frame size, skipping ") + file->name;
+		return false;
+	}
+	file->bitDepth = recording.getBitDepth();
+	file->samplesPerLine = recording.getSamplesPerLine();
+	file->linesPerFrame = recording.getLinesPerFrame();
+	file->bytesPerFrame = recording.getBytesPerFrame();
+	file->numberOfFrames = recording.getNumberOfFrames();
+	return true;
+}
+
+const RecordingFile* BatchProcessor::acquireRecording(BatchFile* file) {
+	//called by worker threads. errors are stored in the file and reported by run(), signals are not emitted from workers
+	QMutexLocker locker(&file->mutex);
+	if(file->failed){
+		return nullptr;
+	}
+	if(file->recording == nullptr){
+		RecordingFile* recording = new RecordingFile();
+		bool opened = recording->open(file->path, this->parameters.bitDepth, this->parameters.samplesPerLine, this->parameters.linesPerFrame, PROCESSED);
+		if(!opened || recording->getBytesPerFrame() != file->bytesPerFrame || recording->getNumberOfFrames() != file->numberOfFrames){
+			file->errorString = opened ? tr("File changed during processing: ") + file->name : recording->getErrorString();
+			file->failed = true;
+			delete recording;
+			return nullptr;
+		}
+		file->recording = recording;
+	}
+	return file->recording;
+}
+
+void BatchProcessor::releaseRecording(BatchFile* file) {
+	//the file is unmapped after its last task
+	QMutexLocker locker(&file->mutex);
+	file->remainingTasks--;
+	if(file->remainingTasks == 0 && file->recording != nullptr){
+		delete file->recording;
+		file->recording = nullptr;
+	}
+}
+
+quint64 BatchProcessor::volumeIndex(quint64 frame) const {
+	return this->parameters.framesPerVolume == 0 ? 0 : frame/this->parameters.framesPerVolume;
+}
+
+void BatchProcessor::processTask(int worker, const BatchTask& task) {
+	BatchFile* file = this->files.at(task.fileIndex);
+	const RecordingFile* recording = this->acquireRecording(file);
+	if(recording == nullptr){
+		this->releaseRecording(file);
+		return;
+	}
+	QRect frameRect(0, 0, static_cast<int>(recording->getSamplesPerLine()), static_cast<int>(recording->getLinesPerFrame()));
+	QRect region = this->parameters.roi.isEmpty() ? frameRect : this->parameters.roi.intersected(frameRect);
+	const uchar* mask = this->mask.isEmpty() ? nullptr : this->mask.constData();
+	QVector<quint32>& histogram = this->workerHistograms[worker];
+
+	//frames of a volume are accumulated locally and merged into the shared volume once per task (or when the volume changes)
+	StatisticsAccumulator accumulator;
+	quint64 currentVolume = this->volumeIndex(task.firstFrame);
+	for(quint64 frame = task.firstFrame; frame < task.firstFrame+task.frameCount; frame++){
+		ImageStatistics statistics = {};
+		bool valid = !region.isEmpty() && StatisticsKernel::calculate(recording->getFrame(frame), recording->getBitDepth(), recording->getSamplesPerLine(), region, mask, recording->getSamplesPerLine(), &statistics, &histogram);
+		statistics.roiX = region.x();
+		statistics.roiY = region.y();
+		statistics.roiWidth = region.width();
+		statistics.roiHeight = region.height();
+		if(!this->parameters.perVolume){
+			FrameResult& result = this->frameResults[task.fileIndex][static_cast<int>(frame)];
+			result.valid = valid;
+			result.statistics = statistics;
+			continue;
+		}
+		quint64 volume = this->volumeIndex(frame);
+		if(volume != currentVolume){
+			Volume* target = this->volumes.at(task.fileIndex).at(static_cast<int>(currentVolume));
+			QMutexLocker locker(&target->mutex);
+			target->accumulator.merge(accumulator);
+			accumulator = StatisticsAccumulator();
+			currentVolume = volume;
+		}
+		if(valid){
+			accumulator.add(statistics, histogram);
+		}
+	}
+	if(this->parameters.perVolume){
+		Volume* target = this->volumes.at(task.fileIndex).at(static_cast<int>(currentVolume));
+		QMutexLocker locker(&target->mutex);
+		target->accumulator.merge(accumulator);
+	}
+	this->releaseRecording(file);
+}
+
+bool BatchProcessor::run() {
+	QVector<BatchTask> tasks;
+	quint64 totalFrames = 0;
+	qreal totalMegabytes = 0;
+	for(int i = 0; i < this->files.size(); i++){
+		BatchFile* file = this->files.at(i);
+		quint64 frames = file->numberOfFrames;
+		for(quint64 first = 0; first < frames; first += BATCH_FRAMES_PER_TASK){
+			tasks.append({i, first, qMin<quint64>(BATCH_FRAMES_PER_TASK, frames-first)});
+			file->remainingTasks++;
+		}
+		totalFrames += frames;
+		totalMegabytes += static_cast<qreal>(frames)*file->bytesPerFrame/1048576.0;
+	}
+
+	int threads = this->parameters.threads > 0 ? this->parameters.threads : QThread::idealThreadCount();
+	WorkStealingScheduler scheduler(threads);
+	this->workerHistograms.fill(QVector<quint32>(), scheduler.getNumberOfWorkers());
+	emit info(tr("Processing ") + QString::number(totalFrames) + tr(" frames of ") + QString::number(this->files.size()) + tr(" files with ") + QString::number(scheduler.getNumberOfWorkers()) + tr(" threads"));
+
+	QElapsedTimer timer;
+	timer.start();
+	scheduler.run(tasks, [this](int worker, const BatchTask& task){this->processTask(worker, task);});
+	qreal seconds = timer.nsecsElapsed()/1.0e9;
+
+	//files that failed while they were processed have no results
+	int failedFiles = this->skippedFiles;
+	for(const BatchFile* file : qAsConst(this->files)){
+		if(file->failed){
+			emit error(file->errorString);
+			failedFiles++;
+		}
+	}
+
+	quint64 rows = 0;
+	if(!this->writeResults(&rows)){
+		return false;
+	}
+	emit info(tr("Rows: ") + QString::number(rows) + tr(", time: ") + QString::number(seconds, 'f', 3) + " s, " + tr("stolen tasks: ") + QString::number(scheduler.getStolenTasks()));
+	if(seconds > 0){
+		emit info(tr("Throughput: ") + QString::number(totalFrames/seconds, 'f', 1) + tr(" frames/s, ") + QString::number(totalMegabytes/seconds, 'f', 1) + " MiB/s");
+	}
+	if(failedFiles > 0){
+		emit error(tr("Failed files: ") + QString::number(failedFiles) + tr(" of ") + QString::number(this->files.size()+this->skippedFiles));
+		return false;
+	}
+	return true;
+}
+
+QByteArray BatchProcessor::formatMetrics(const ImageStatistics& statistics, quint64 pixels) const {
+	//pixels is passed separately, because the number of pixels of a volume can exceed the range of ImageStatistics::pixels
+	QByteArray line;
+	for(BATCH_METRIC metric : this->parameters.metrics){
+		line.append(',');
+		switch(metric){
+			case METRIC_PIXELS: line.append(QByteArray::number(pixels)); break;
+			case METRIC_MIN: line.append(QByteArray::number(statistics.min, 'g', 10)); break;
+			case METRIC_MAX: line.append(QByteArray::number(statistics.max, 'g', 10)); break;
+			case METRIC_SUM: line.append(QByteArray::number(statistics.sum, 'g', 15)); break;
+			case METRIC_MEAN: line.append(QByteArray::number(statistics.average, 'g', 10)); break;
+			case METRIC_STD_DEVIATION: line.append(QByteArray::number(statistics.stdDeviation, 'g', 10)); break;
+			case METRIC_COEFF_OF_VARIATION: line.append(QByteArray::number(statistics.coeffOfVariation, 'g', 10)); break;
+			case METRIC_PERCENTILE_5: line.append(QByteArray::number(statistics.percentile5, 'g', 10)); break;
+			case METRIC_MEDIAN: line.append(QByteArray::number(statistics.median, 'g', 10)); break;
+			case METRIC_PERCENTILE_95: line.append(QByteArray::number(statistics.percentile95, 'g', 10)); break;
+		}
+	}
+	return line;
+}
+
+bool BatchProcessor::writeResults(quint64* rows) {
+	QFile file;
+	bool opened = false;
+	if(this->parameters.outputFile.isEmpty() || this->parameters.outputFile == "-"){
+		opened = file.open(stdout, QIODevice::WriteOnly);
+	}else{
+		file.setFileName(this->parameters.outputFile);
+		opened = file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+	}
+	if(!opened){
+		emit error(tr("Could not open ") + this->parameters.outputFile);
+		return false;
+	}
+
+	//frames without evaluated samples (empty roi or mask) get empty metric fields
+	QByteArray emptyMetrics(this->parameters.metrics.size(), ',');
+	QByteArray buffer = this->parameters.perVolume ? "file,volume,frames" : "file,frame";
+	for(BATCH_METRIC metric : this->parameters.metrics){
+		buffer.append(',').append(metricNames[metric]);
+	}
+	buffer.append('\n');
+	*rows = 0;
+	for(int i = 0; i < this->files.size(); i++){
+		if(this->files.at(i)->failed){
+			continue;
+		}
+		QByteArray fileName = this->files.at(i)->name.toUtf8();
+		if(this->parameters.perVolume){
+			const QVector<Volume*>& fileVolumes = this->volumes.at(i);
+			for(int v = 0; v < fileVolumes.size(); v++){
+				const StatisticsAccumulator& accumulator = fileVolumes.at(v)->accumulator;
+				buffer.append(fileName).append(',').append(QByteArray::number(v)).append(',').append(QByteArray::number(accumulator.getFrames()));
+				buffer.append(accumulator.isEmpty() ? emptyMetrics : this->formatMetrics(accumulator.getStatistics(), accumulator.getPixels())).append('\n');
+				(*rows)++;
+			}
+		}else{
+			const QVector<FrameResult>& results = this->frameResults.at(i);
+			for(int f = 0; f < results.size(); f++){
+				buffer.append(fileName).append(',').append(QByteArray::number(f));
+				buffer.append(results.at(f).valid ? this->formatMetrics(results.at(f).statistics, static_cast<quint64>(results.at(f).statistics.pixels)) : emptyMetrics).append('\n');
+				(*rows)++;
+			}
+		}
+		//rows are written file by file, so the buffer stays small
+		if(file.write(buffer) != buffer.size()){
+			emit error(tr("Could not write results."));
+			return false;
+		}
+		buffer.clear();
+	}
+	file.flush();
+	return true;
+}
@@ -0,0 +1,158 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#ifndef BATCHPROCESSOR_H
+#define BATCHPROCESSOR_H
+
+#define BATCH_FRAMES_PER_TASK 8 //frames per scheduled task, small enough for load balancing and large enough to keep locking rare
+
+#include <QObject>
+#include <QMutex>
+#include <QRect>
+#include <QStringList>
+#include <QVector>
+#include "recordingfile.h"
+#include "statisticskernel.h"
+#include "workstealingscheduler.h"
+
+enum BATCH_METRIC {
+	METRIC_PIXELS,
+	METRIC_MIN,
+	METRIC_MAX,
+	METRIC_SUM,
+	METRIC_MEAN,
+	METRIC_STD_DEVIATION,
+	METRIC_COEFF_OF_VARIATION,
+	METRIC_PERCENTILE_5,
+	METRIC_MEDIAN,
+	METRIC_PERCENTILE_95
+};
+
+struct BatchParameters {
+	QString directory;
+	QStringList nameFilters;
+	unsigned int bitDepth; //only needed for recordings without capture header
+	unsigned int samplesPerLine;
+	unsigned int linesPerFrame;
+	QRect roi; //empty roi evaluates whole frame
+	QString maskFile; //8 bit binary pgm with frame size, samples with mask value 0 are skipped
+	QList<BATCH_METRIC> metrics;
+	bool perVolume; //one output row per volume instead of per frame
+	quint64 framesPerVolume; //0: every file is one volume
+	int threads;
+	QString outputFile; //"-" or empty for standard output
+};
+
+//combines the statistics and histograms of several frames into the statistics of a volume
+class StatisticsAccumulator
+{
+public:
+	StatisticsAccumulator();
+
+	void add(const ImageStatistics& statistics, const QVector<quint32>& histogram);
+	void merge(const StatisticsAccumulator& other);
+	bool isEmpty() const {return this->pixels == 0;}
+	quint64 getFrames() const {return this->frames;}
+	quint64 getPixels() const {return this->pixels;}
+	ImageStatistics getStatistics() const;
+
+private:
+	quint64 frames;
+	quint64 pixels;
+	qreal sum;
+	qreal squaredDeviations; //sum of squared deviations from the mean, combined with the parallel variance algorithm
+	qreal min;
+	qreal max;
+	QVector<quint32> histogram;
+
+	void combine(quint64 otherPixels, qreal otherSum, qreal otherSquaredDeviations);
+};
+
+//BatchProcessor calculates the statistics of all frames of all recordings in a directory with the statistics kernel of the extension
+class BatchProcessor : public QObject
+{
+	Q_OBJECT
+public:
+	explicit BatchProcessor(QObject* parent = nullptr);
+	~BatchProcessor();
+
+	static bool parseMetrics(const QString& text, QList<BATCH_METRIC>* metrics);
+	bool open(const BatchParameters& parameters);
+	bool run();
+
+private:
+	struct FrameResult {
+		bool valid;
+		ImageStatistics statistics;
+	};
+	struct Volume {
+		QMutex mutex;
+		StatisticsAccumulator accumulator;
+	};
+	//files are only probed in open(). a file is mapped by the first task that processes it and closed after its last task,
+	//so only about one file per worker is open at a time
+	struct BatchFile {
+		QString name;
+		QString path;
+		unsigned int bitDepth;
+		unsigned int samplesPerLine;
+		unsigned int linesPerFrame;
+		size_t bytesPerFrame;
+		quint64 numberOfFrames;
+		QMutex mutex;
+		RecordingFile* recording;
+		int remainingTasks;
+		bool failed;
+		QString errorString;
+	};
+
+	BatchParameters parameters;
+	QVector<BatchFile*> files;
+	int skippedFiles; //files that could not be probed in open()
+	QVector<QVector<FrameResult>> frameResults;
+	QVector<QVector<Volume*>> volumes;
+	QVector<QVector<quint32>> workerHistograms;
+	QVector<uchar> mask;
+	int maskWidth;
+	int maskHeight;
+
+	bool readMask(const QString& fileName);
+	bool probeFile(BatchFile* file);
+	const RecordingFile* acquireRecording(BatchFile* file);
+	void releaseRecording(BatchFile* file);
+	quint64 volumeIndex(quint64 frame) const;
+	void processTask(int worker, const BatchTask& task);
+	bool writeResults(quint64* rows);
+	QByteArray formatMetrics(const ImageStatistics& statistics, quint64 pixels) const;
+
+signals:
+	void info(QString);
+	void error(QString);
+};
+
+#endif // BATCHPROCESSOR_H
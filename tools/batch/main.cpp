@@ -0,0 +1,95 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTextStream>
+#include "batchprocessor.h"
+
+
+static QRect parseRect(const QString& text) {
+	QStringList values = text.split(',');
+	if(values.size() != 4){
+		return QRect();
+	}
+	return QRect(values.at(0).toInt(), values.at(1).toInt(), values.at(2).toInt(), values.at(3).toInt());
+}
+
+int main(int argc, char* argv[]) {
+	QCoreApplication app(argc, argv);
+	QCoreApplication::setApplicationName("imagestatistics-batch");
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Calculates statistics of all frames of all recordings in a directory with the statistics kernel of the Image Statistics Extension.");
+	parser.addHelpOption();
+	parser.addPositionalArgument("directory", "Directory with recordings (raw data without header) or frame captures (*.cap).");
+	QCommandLineOption outputOption(QStringList() << "o" << "output", "Write csv results to <file> instead of standard output.", "file");
+	QCommandLineOption filterOption("filter", "Comma separated file name filters.", "filters", "*");
+	QCommandLineOption bitDepthOption("bitdepth", "Bit depth of recordings without header.", "bits");
+	QCommandLineOption samplesOption("samples", "Samples per line of recordings without header.", "samples");
+	QCommandLineOption linesOption("lines", "Lines per frame of recordings without header.", "lines");
+	QCommandLineOption roiOption("roi", "Region of interest, default is the whole frame.", "x,y,width,height");
+	QCommandLineOption maskOption("mask", "Binary 8 bit pgm with frame size, samples with mask value 0 are skipped.", "file");
+	QCommandLineOption metricsOption("metrics", "Comma separated list of pixels, min, max, sum, mean, std, cv, p5, median, p95 or all.", "metrics", "mean,std,min,max,median");
+	QCommandLineOption perVolumeOption("per-volume", "Write one row per volume instead of one row per frame.");
+	QCommandLineOption framesPerVolumeOption("frames-per-volume", "Number of frames of a volume, default is one volume per file.", "frames", "0");
+	QCommandLineOption threadsOption("threads", "Number of worker threads, default is the number of cores.", "n", "0");
+	parser.addOptions({outputOption, filterOption, bitDepthOption, samplesOption, linesOption, roiOption, maskOption, metricsOption, perVolumeOption, framesPerVolumeOption, threadsOption});
+	parser.process(app);
+
+	QTextStream err(stderr);
+	if(parser.positionalArguments().size() != 1){
+		parser.showHelp(1);
+	}
+
+	BatchParameters parameters;
+	parameters.directory = parser.positionalArguments().first();
+	parameters.nameFilters = parser.value(filterOption).split(',', Qt::SkipEmptyParts);
+	parameters.bitDepth = parser.value(bitDepthOption).toUInt();
+	parameters.samplesPerLine = parser.value(samplesOption).toUInt();
+	parameters.linesPerFrame = parser.value(linesOption).toUInt();
+	parameters.roi = parseRect(parser.value(roiOption));
+	parameters.maskFile = parser.value(maskOption);
+	parameters.perVolume = parser.isSet(perVolumeOption) || parser.isSet(framesPerVolumeOption);
+	parameters.framesPerVolume = parser.value(framesPerVolumeOption).toULongLong();
+	parameters.threads = parser.value(threadsOption).toInt();
+	parameters.outputFile = parser.value(outputOption);
+	if(!BatchProcessor::parseMetrics(parser.value(metricsOption), &parameters.metrics)){
+		err << "Error: Unknown metric in " << parser.value(metricsOption) << "\n";
+		return 1;
+	}
+
+	//messages go to stderr, so results can be written to stdout
+	BatchProcessor processor;
+	QObject::connect(&processor, &BatchProcessor::info, [&err](QString message){err << message << "\n"; err.flush();});
+	QObject::connect(&processor, &BatchProcessor::error, [&err](QString message){err << "Error: " << message << "\n"; err.flush();});
+	if(!processor.open(parameters)){
+		return 1;
+	}
+	return processor.run() ? 0 : 1;
+}
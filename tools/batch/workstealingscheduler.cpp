@@ -0,0 +1,105 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#include "workstealingscheduler.h"
+#include <QMutexLocker>
+
+
+WorkStealingScheduler::WorkStealingScheduler(int numberOfWorkers)
+{
+	for(int i = 0; i < qMax(1, numberOfWorkers); i++){
+		this->queues.append(new WorkerQueue());
+	}
+	this->stolenTasks.storeRelaxed(0);
+}
+
+WorkStealingScheduler::~WorkStealingScheduler()
+{
+	qDeleteAll(this->queues);
+}
+
+void WorkStealingScheduler::run(const QVector<BatchTask>& tasks, TaskFunction function) {
+	this->function = function;
+
+	//contiguous blocks of tasks for each worker
+	int numberOfWorkers = this->queues.size();
+	for(int i = 0; i < numberOfWorkers; i++){
+		int first = static_cast<int>(static_cast<qint64>(tasks.size())*i/numberOfWorkers);
+		int last = static_cast<int>(static_cast<qint64>(tasks.size())*(i+1)/numberOfWorkers);
+		this->queues[i]->tasks.assign(tasks.constBegin()+first, tasks.constBegin()+last);
+	}
+
+	//no tasks are added while the workers run, so a worker can stop as soon as it finds all queues empty
+	QVector<Worker*> workers;
+	for(int i = 0; i < numberOfWorkers; i++){
+		Worker* worker = new Worker(this, i);
+		workers.append(worker);
+		worker->start();
+	}
+	for(Worker* worker : qAsConst(workers)){
+		worker->wait();
+	}
+	qDeleteAll(workers);
+}
+
+void WorkStealingScheduler::work(int worker) {
+	BatchTask task;
+	forever{
+		if(!this->takeOwnTask(worker, &task) && !this->stealTask(worker, &task)){
+			return;
+		}
+		this->function(worker, task);
+	}
+}
+
+bool WorkStealingScheduler::takeOwnTask(int worker, BatchTask* task) {
+	WorkerQueue* queue = this->queues[worker];
+	QMutexLocker locker(&queue->mutex);
+	if(queue->tasks.empty()){
+		return false;
+	}
+	*task = queue->tasks.front();
+	queue->tasks.pop_front();
+	return true;
+}
+
+bool WorkStealingScheduler::stealTask(int thief, BatchTask* task) {
+	//victims are visited starting with the next worker, so thieves spread over the queues
+	int numberOfWorkers = this->queues.size();
+	for(int i = 1; i < numberOfWorkers; i++){
+		WorkerQueue* queue = this->queues[(thief+i)%numberOfWorkers];
+		QMutexLocker locker(&queue->mutex);
+		if(!queue->tasks.empty()){
+			*task = queue->tasks.back();
+			queue->tasks.pop_back();
+			this->stolenTasks.fetchAndAddRelaxed(1);
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,86 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#ifndef WORKSTEALINGSCHEDULER_H
+#define WORKSTEALINGSCHEDULER_H
+
+#include <QMutex>
+#include <QThread>
+#include <QVector>
+#include <QAtomicInteger>
+#include <deque>
+#include <functional>
+
+struct BatchTask {
+	int fileIndex;
+	quint64 firstFrame;
+	quint64 frameCount;
+};
+
+//WorkStealingScheduler processes a fixed set of tasks with a number of worker threads. Every worker gets a contiguous
+//block of the tasks, so it reads neighboring frames, and takes tasks from the front of its own queue. A worker with
+//an empty queue steals from the back of the other queues, so files with different sizes or slow storage do not leave workers idle.
+class WorkStealingScheduler
+{
+public:
+	typedef std::function<void(int worker, const BatchTask& task)> TaskFunction;
+
+	explicit WorkStealingScheduler(int numberOfWorkers);
+	~WorkStealingScheduler();
+
+	int getNumberOfWorkers() const {return this->queues.size();}
+	quint64 getStolenTasks() const {return this->stolenTasks.loadAcquire();}
+	void run(const QVector<BatchTask>& tasks, TaskFunction function);
+
+private:
+	struct WorkerQueue {
+		QMutex mutex;
+		std::deque<BatchTask> tasks;
+	};
+
+	class Worker : public QThread
+	{
+	public:
+		Worker(WorkStealingScheduler* scheduler, int index) : scheduler(scheduler), index(index) {}
+	protected:
+		void run() override {this->scheduler->work(this->index);}
+	private:
+		WorkStealingScheduler* scheduler;
+		int index;
+	};
+
+	QVector<WorkerQueue*> queues;
+	TaskFunction function;
+	QAtomicInteger<quint64> stolenTasks;
+
+	void work(int worker);
+	bool takeOwnTask(int worker, BatchTask* task);
+	bool stealTask(int thief, BatchTask* task);
+};
+
+#endif // WORKSTEALINGSCHEDULER_H
@@ -0,0 +1,47 @@
+QT	   = core gui widgets printsupport network
+CONFIG += console
+CONFIG -= app_bundle
+
+TARGET = imagestatistics-loadgen
+TEMPLATE = app
+
+#define path of OCTproZ_DevKit share directory, the extension is loaded from there by default
+SHAREDIR = $$shell_path($$PWD/../../../../octproz_share_dev)
+
+DEFINES += \
+	QT_DEPRECATED_WARNINGS #emit warnings if depracted Qt features are used
+
+SOURCES += \
+	main.cpp \
+	loadgenerator.cpp \
+	stubhost.cpp
+
+HEADERS += \
+	loadgenerator.h \
+	stubhost.h
+
+#the extension itself is loaded as plugin at runtime, its headers are only needed for the settings keys
+INCLUDEPATH += $$SHAREDIR \
+	$$PWD/../../src \
+	$$PWD/../../src/thirdparty/qcustomplot
+
+#latency histograms and buffer source definitions are taken from the core library
+include(../../src/core/imagestatisticscore.pri)
+
+#the host needs the Plugin and Extension classes of the OCTproZ_DevKit like OCTproZ itself
+CONFIG(debug, debug|release) {
+	unix{
+		LIBS += $$shell_path($$SHAREDIR/debug/libOCTproZ_DevKit.a)
+	}
+	win32{
+		LIBS += $$shell_path($$SHAREDIR/debug/OCTproZ_DevKit.lib)
+	}
+}
+CONFIG(release, debug|release) {
+	unix{
+		LIBS += $$shell_path($$SHAREDIR/release/libOCTproZ_DevKit.a)
+	}
+	win32{
+		LIBS += $$shell_path($$SHAREDIR/release/OCTproZ_DevKit.lib)
+	}
+}
@@ -0,0 +1,113 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#include "loadgenerator.h"
+#include <cstring>
+#include <chrono>
+#include <thread>
+
+
+LoadGenerator::LoadGenerator(Extension* extension, BUFFER_SOURCE source, const LoadParameters& parameters)
+{
+	this->extension = extension;
+	this->source = source;
+	this->parameters = parameters;
+	this->stopRequested.storeRelaxed(0);
+	this->sentBuffers.storeRelaxed(0);
+	this->lateBuffers.storeRelaxed(0);
+	this->maxCallLatency.storeRelaxed(0);
+	this->fillBuffers();
+}
+
+void LoadGenerator::fillBuffers() {
+	//noise with the full range of the bit depth, every buffer differs so the extension can not profit from cached data
+	size_t bytesPerSample = (this->parameters.bitDepth+7)/8;
+	size_t samples = static_cast<size_t>(this->parameters.samplesPerLine)*this->parameters.linesPerFrame*this->parameters.framesPerBuffer;
+	quint32 mask = this->parameters.bitDepth >= 32 ? 0xFFFFFFFF : (1u << this->parameters.bitDepth)-1;
+	quint32 state = this->source == RAW ? 0x12345678 : 0x9abcdef1;
+	for(int i = 0; i < LOADGEN_BUFFERS; i++){
+		QByteArray buffer(static_cast<int>(samples*bytesPerSample), Qt::Uninitialized);
+		char* data = buffer.data();
+		for(size_t j = 0; j < samples; j++){
+			//xorshift32
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+			quint32 value = state & mask;
+			memcpy(&data[j*bytesPerSample], &value, bytesPerSample);
+		}
+		this->buffers.append(buffer);
+	}
+}
+
+void LoadGenerator::run() {
+	using Clock = std::chrono::steady_clock;
+	std::chrono::nanoseconds interval(0);
+	if(this->parameters.lineRate > 0){
+		double linesPerBuffer = static_cast<double>(this->parameters.linesPerFrame)*this->parameters.framesPerBuffer;
+		interval = std::chrono::nanoseconds(static_cast<qint64>(1000000000.0*linesPerBuffer/this->parameters.lineRate));
+	}
+	Clock::time_point deadline = Clock::now();
+	unsigned int currentBufferNr = 0;
+	int buffersInBurst = 0;
+	quint64 sent = 0;
+
+	while(this->stopRequested.loadAcquire() == 0){
+		Clock::time_point now = Clock::now();
+		if(now < deadline){
+			std::this_thread::sleep_until(deadline);
+		}else if(interval.count() == 0 || now-deadline > interval){
+			//the previous call blocked the "acquisition" for more than one buffer period
+			if(interval.count() > 0){
+				this->lateBuffers.storeRelease(this->lateBuffers.loadRelaxed()+1);
+			}
+			deadline = now;
+		}
+
+		void* buffer = this->buffers[static_cast<int>(sent%LOADGEN_BUFFERS)].data();
+		Clock::time_point callStart = Clock::now();
+		if(this->source == RAW){
+			this->extension->rawDataReceived(buffer, this->parameters.bitDepth, this->parameters.samplesPerLine, this->parameters.linesPerFrame, this->parameters.framesPerBuffer, this->parameters.buffersPerVolume, currentBufferNr);
+		}else{
+			this->extension->processedDataReceived(buffer, this->parameters.bitDepth, this->parameters.samplesPerLine, this->parameters.linesPerFrame, this->parameters.framesPerBuffer, this->parameters.buffersPerVolume, currentBufferNr);
+		}
+		qint64 callLatency = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now()-callStart).count();
+		this->callLatency.add(callLatency);
+		if(callLatency > this->maxCallLatency.loadRelaxed()){
+			this->maxCallLatency.storeRelease(callLatency);
+		}
+		this->sentBuffers.storeRelease(++sent);
+		currentBufferNr = (currentBufferNr+1)%this->parameters.buffersPerVolume;
+
+		deadline += interval;
+		if(this->parameters.burstBuffers > 0 && ++buffersInBurst >= this->parameters.burstBuffers){
+			buffersInBurst = 0;
+			deadline += std::chrono::milliseconds(this->parameters.burstPauseMs);
+		}
+	}
+}
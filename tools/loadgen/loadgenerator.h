@@ -0,0 +1,93 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#ifndef LOADGENERATOR_H
+#define LOADGENERATOR_H
+
+#define LOADGEN_BUFFERS 4 //number of different buffers that are passed to the extension in turn, like the acquisition buffers of OCTproZ
+
+#include <QThread>
+#include <QVector>
+#include <QByteArray>
+#include <QAtomicInt>
+#include <QAtomicInteger>
+#include "octproz_devkit.h"
+#include "frameingest.h"
+#include "statisticsmetrics.h"
+
+struct LoadParameters {
+	QString pluginFile;
+	BUFFER_SOURCE source;
+	unsigned int bitDepth;
+	unsigned int samplesPerLine;
+	unsigned int linesPerFrame;
+	unsigned int framesPerBuffer;
+	unsigned int buffersPerVolume;
+	double lineRate; //lines per second, 0 sends buffers as fast as possible
+	int burstBuffers; //buffers sent at the line rate before a pause, 0 sends continuously
+	int burstPauseMs;
+	double duration; //seconds
+	int metricsPort;
+	bool showWindow;
+	double maxDropRate; //fraction of sent buffers, negative disables the check
+	double maxLatencyMs; //99th percentile of the end-to-end latency, negative disables the check
+};
+
+//LoadGenerator calls rawDataReceived or processedDataReceived of the extension from its own thread with synthetic
+//buffers, like the acquisition or processing thread of OCTproZ. Buffers that can not be sent in time because the
+//previous call took too long are counted as late.
+class LoadGenerator : public QThread
+{
+public:
+	LoadGenerator(Extension* extension, BUFFER_SOURCE source, const LoadParameters& parameters);
+
+	BUFFER_SOURCE getSource() const {return this->source;}
+	void stop(){this->stopRequested.storeRelease(1);}
+	quint64 getSentBuffers() const {return this->sentBuffers.loadAcquire();}
+	quint64 getLateBuffers() const {return this->lateBuffers.loadAcquire();}
+	const LatencyHistogram& getCallLatency() const {return this->callLatency;}
+	qint64 getMaxCallLatency() const {return this->maxCallLatency.loadAcquire();}
+
+protected:
+	void run() override;
+
+private:
+	Extension* extension;
+	BUFFER_SOURCE source;
+	LoadParameters parameters;
+	QVector<QByteArray> buffers;
+	QAtomicInt stopRequested;
+	QAtomicInteger<quint64> sentBuffers;
+	QAtomicInteger<quint64> lateBuffers;
+	QAtomicInteger<qint64> maxCallLatency;
+	LatencyHistogram callLatency; //microseconds spent in the data callback of the extension
+
+	void fillBuffers();
+};
+
+#endif // LOADGENERATOR_H
@@ -0,0 +1,112 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QTextStream>
+#include "stubhost.h"
+
+
+int main(int argc, char* argv[]) {
+	//the extension creates its widgets also if the window is not shown, run with -platform offscreen on machines without display
+	QApplication app(argc, argv);
+	QCoreApplication::setApplicationName("imagestatistics-loadgen");
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Loads the Image Statistics Extension under a stub host and feeds it with synthetic buffers to measure drops, latency and cpu time per frame for a scanner configuration.");
+	parser.addHelpOption();
+	parser.addPositionalArgument("plugin", "Extension library, e.g. libImageStatisticsExtension.so.");
+	QCommandLineOption sourceOption("source", "Buffer source: raw, processed or both.", "source", "processed");
+	QCommandLineOption bitDepthOption("bitdepth", "Bit depth of the samples.", "bits", "12");
+	QCommandLineOption samplesOption("samples", "Samples per line.", "samples", "1024");
+	QCommandLineOption linesOption("lines", "Lines per frame.", "lines", "512");
+	QCommandLineOption framesOption("frames", "Frames per buffer.", "frames", "1");
+	QCommandLineOption buffersOption("buffers", "Buffers per volume.", "buffers", "1");
+	QCommandLineOption lineRateOption("line-rate", "Lines per second, 0 sends buffers as fast as possible.", "hz", "100000");
+	QCommandLineOption burstOption("burst", "Send <n> buffers at the line rate, then pause for <ms> milliseconds.", "n:ms");
+	QCommandLineOption durationOption("duration", "Duration of the load in seconds.", "s", "10");
+	QCommandLineOption portOption("metrics-port", "Localhost port of the metrics endpoint of the extension.", "port", QString::number(DEFAULT_METRICS_PORT));
+	QCommandLineOption showOption("show", "Show the extension window during the run.");
+	QCommandLineOption maxDropsOption("max-drops", "Fail if more than <percent> of the sent buffers were not processed.", "percent", "-1");
+	QCommandLineOption maxLatencyOption("max-latency", "Fail if the 99th percentile of the end-to-end latency is above <ms>.", "ms", "-1");
+	QCommandLineOption verboseOption("verbose", "Print info messages of the extension.");
+	parser.addOptions({sourceOption, bitDepthOption, samplesOption, linesOption, framesOption, buffersOption, lineRateOption, burstOption, durationOption, portOption, showOption, maxDropsOption, maxLatencyOption, verboseOption});
+	parser.process(app);
+
+	QTextStream err(stderr);
+	if(parser.positionalArguments().size() != 1){
+		parser.showHelp(1);
+	}
+
+	LoadParameters parameters;
+	parameters.pluginFile = parser.positionalArguments().first();
+	QString source = parser.value(sourceOption).toLower();
+	parameters.source = source == "raw" ? RAW : (source == "both" ? RAW_AND_PROCESSED : PROCESSED);
+	parameters.bitDepth = parser.value(bitDepthOption).toUInt();
+	parameters.samplesPerLine = parser.value(samplesOption).toUInt();
+	parameters.linesPerFrame = parser.value(linesOption).toUInt();
+	parameters.framesPerBuffer = parser.value(framesOption).toUInt();
+	parameters.buffersPerVolume = parser.value(buffersOption).toUInt();
+	parameters.lineRate = parser.value(lineRateOption).toDouble();
+	parameters.burstBuffers = 0;
+	parameters.burstPauseMs = 0;
+	if(parser.isSet(burstOption)){
+		QStringList burst = parser.value(burstOption).split(':');
+		bool buffersValid = false;
+		bool pauseValid = false;
+		if(burst.size() == 2){
+			parameters.burstBuffers = burst.at(0).toInt(&buffersValid);
+			parameters.burstPauseMs = burst.at(1).toInt(&pauseValid);
+		}
+		if(!buffersValid || !pauseValid || parameters.burstBuffers <= 0 || parameters.burstPauseMs < 0){
+			err << "Error: Invalid burst " << parser.value(burstOption) << ", expected <n>:<ms>!\n";
+			return 1;
+		}
+	}
+	parameters.duration = parser.value(durationOption).toDouble();
+	parameters.metricsPort = parser.value(portOption).toInt();
+	parameters.showWindow = parser.isSet(showOption);
+	parameters.maxDropRate = parser.value(maxDropsOption).toDouble()/100.0;
+	parameters.maxLatencyMs = parser.value(maxLatencyOption).toDouble();
+	if(parameters.bitDepth == 0 || parameters.bitDepth > 32 || parameters.samplesPerLine == 0 || parameters.linesPerFrame == 0 || parameters.framesPerBuffer == 0 || parameters.buffersPerVolume == 0){
+		err << "Error: Invalid data dimensions!\n";
+		return 1;
+	}
+
+	//messages go to stderr, the report is written to stdout
+	bool verbose = parser.isSet(verboseOption);
+	StubHost host;
+	QObject::connect(&host, &StubHost::info, [&err, verbose](QString message){if(verbose){err << message << "\n"; err.flush();}});
+	QObject::connect(&host, &StubHost::error, [&err](QString message){err << "Error: " << message << "\n"; err.flush();});
+	QObject::connect(&host, &StubHost::finished, &app, &QCoreApplication::exit);
+	if(!host.load(parameters)){
+		return 1;
+	}
+	host.start();
+	return app.exec();
+}
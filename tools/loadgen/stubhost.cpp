@@ -0,0 +1,258 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#include "stubhost.h"
+#include "imagestatisticsextensionform.h"
+#include <QTextStream>
+#include <QWidget>
+#include <cstring>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
+
+StubHost::StubHost(QObject* parent) : QObject(parent)
+{
+	this->extension = nullptr;
+	this->widget = nullptr;
+	this->startCpuTime = 0;
+	this->cpuTime = 0;
+	this->wallTime = 0;
+	this->metricsSocket = nullptr;
+	this->durationTimer.setSingleShot(true);
+	connect(&this->durationTimer, &QTimer::timeout, this, &StubHost::slot_stopLoad);
+}
+
+StubHost::~StubHost()
+{
+	for(LoadGenerator* generator : qAsConst(this->generators)){
+		generator->stop();
+		generator->wait();
+	}
+	qDeleteAll(this->generators);
+
+	//the widget belongs to the host once it was requested, its code is part of the plugin, so it is deleted before unloading
+	delete this->extension;
+	delete this->widget;
+	this->loader.unload();
+}
+
+bool StubHost::load(const LoadParameters& parameters) {
+	this->parameters = parameters;
+	this->loader.setFileName(parameters.pluginFile);
+	QObject* instance = this->loader.instance();
+	this->extension = qobject_cast<Extension*>(instance);
+	if(this->extension == nullptr){
+		emit error(tr("Could not load extension ") + parameters.pluginFile + ": " + this->loader.errorString());
+		return false;
+	}
+	connect(this->extension, &Plugin::info, this, &StubHost::info);
+	connect(this->extension, &Plugin::error, this, &StubHost::error);
+
+	//the metrics endpoint is enabled with the settings, every buffer of a volume is evaluated
+	QVariantMap settings;
+	settings.insert(BUFFER_SRC, parameters.source);
+	settings.insert(BUFFER_NR, -1);
+	settings.insert(FRAME_NR, 0);
+	settings.insert(AUTO_UPDATE_HISTOGRAM, parameters.showWindow);
+	settings.insert(AUTO_UPDATE_STATISTICS, parameters.showWindow);
+	settings.insert(METRICS_ENABLED, true);
+	settings.insert(METRICS_PORT, parameters.metricsPort);
+	this->extension->settingsLoaded(settings);
+	if(parameters.showWindow){
+		this->widget = this->extension->getWidget();
+		this->widget->show();
+	}
+
+	if(parameters.source == RAW || parameters.source == RAW_AND_PROCESSED){
+		this->generators.append(new LoadGenerator(this->extension, RAW, parameters));
+	}
+	if(parameters.source == PROCESSED || parameters.source == RAW_AND_PROCESSED){
+		this->generators.append(new LoadGenerator(this->extension, PROCESSED, parameters));
+	}
+	return true;
+}
+
+void StubHost::start() {
+	this->extension->enableRawDataGrabbing(true);
+	this->extension->enableProcessedDataGrabbing(true);
+	this->extension->activateExtension();
+	this->startCpuTime = processCpuTime();
+	this->wallTimer.start();
+	for(LoadGenerator* generator : qAsConst(this->generators)){
+		generator->start(QThread::TimeCriticalPriority);
+	}
+	this->durationTimer.start(static_cast<int>(this->parameters.duration*1000.0));
+}
+
+void StubHost::slot_stopLoad() {
+	for(LoadGenerator* generator : qAsConst(this->generators)){
+		generator->stop();
+		generator->wait();
+	}
+	this->wallTime = this->wallTimer.nsecsElapsed()/1000;
+	QTimer::singleShot(LOADGEN_DRAIN_MS, this, &StubHost::slot_requestMetrics);
+}
+
+void StubHost::slot_requestMetrics() {
+	//cpu time includes the processing of frames that were still queued when the load stopped
+	this->cpuTime = processCpuTime()-this->startCpuTime;
+	this->extension->deactivateExtension();
+
+	//the endpoint is served by the event loop of this thread, so the response is read asynchronously
+	this->metricsSocket = new QTcpSocket(this);
+	connect(this->metricsSocket, &QTcpSocket::connected, this, [this](){
+		this->metricsSocket->write("GET /metrics HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n");
+	});
+	connect(this->metricsSocket, &QTcpSocket::readyRead, this, [this](){
+		this->metricsResponse += this->metricsSocket->readAll();
+	});
+	connect(this->metricsSocket, &QTcpSocket::disconnected, this, &StubHost::slot_evaluateMetrics);
+	auto onSocketError = [this](QAbstractSocket::SocketError socketError){
+		if(socketError != QAbstractSocket::RemoteHostClosedError){
+			this->metricsSocket->disconnect(this);
+			emit error(tr("Could not read metrics: ") + this->metricsSocket->errorString());
+			emit finished(1);
+		}
+	};
+	//QAbstractSocket::error is deprecated since Qt 5.15
+#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+	connect(this->metricsSocket, &QAbstractSocket::errorOccurred, this, onSocketError);
+#else
+	connect(this->metricsSocket, QOverload<QAbstractSocket::SocketError>::of(&QAbstractSocket::error), this, onSocketError);
+#endif
+	this->metricsSocket->connectToHost(QHostAddress::LocalHost, static_cast<quint16>(this->parameters.metricsPort));
+}
+
+void StubHost::slot_evaluateMetrics() {
+	this->metricsResponse += this->metricsSocket->readAll();
+	QHash<QByteArray, double> metrics = parseMetrics(this->metricsResponse);
+	if(metrics.isEmpty()){
+		emit error(tr("Metrics response is empty or invalid."));
+		emit finished(1);
+		return;
+	}
+	emit finished(this->report(metrics));
+}
+
+QHash<QByteArray, double> StubHost::parseMetrics(const QByteArray& response) {
+	//samples are stored by name and labels, e.g. frames_received_total{source="raw"}
+	QHash<QByteArray, double> metrics;
+	int bodyStart = response.indexOf("\r\n\r\n");
+	if(!response.startsWith("HTTP/1.1 200") || bodyStart < 0){
+		return metrics;
+	}
+	const QList<QByteArray> lines = response.mid(bodyStart+4).split('\n');
+	for(const QByteArray& line : lines){
+		if(line.isEmpty() || line.startsWith('#') || !line.startsWith(METRICS_PREFIX)){
+			continue;
+		}
+		int separator = line.lastIndexOf(' ');
+		metrics.insert(line.mid(static_cast<int>(strlen(METRICS_PREFIX)), separator-static_cast<int>(strlen(METRICS_PREFIX))), line.mid(separator+1).toDouble());
+	}
+	return metrics;
+}
+
+int StubHost::report(const QHash<QByteArray, double>& metrics) {
+	QTextStream out(stdout);
+	out.setRealNumberNotation(QTextStream::FixedNotation);
+	out.setRealNumberPrecision(2);
+	bool passed = true;
+	double processedFrames = 0;
+
+	double seconds = static_cast<double>(this->wallTime)/1000000.0;
+	out << "load: " << this->parameters.bitDepth << " bit, " << this->parameters.samplesPerLine << "x" << this->parameters.linesPerFrame << " samples per frame, "
+		<< this->parameters.framesPerBuffer << " frames per buffer, line rate " << this->parameters.lineRate << " Hz";
+	if(this->parameters.burstBuffers > 0){
+		out << ", bursts of " << this->parameters.burstBuffers << " buffers with " << this->parameters.burstPauseMs << " ms pause";
+	}
+	out << ", " << seconds << " s\n";
+
+	for(LoadGenerator* generator : qAsConst(this->generators)){
+		QByteArray source = generator->getSource() == RAW ? "raw" : "processed";
+		QByteArray label = "source=\"" + source + "\"";
+		double sent = static_cast<double>(generator->getSentBuffers());
+		double processed = metrics.value("frames_processed_total{" + label + "}");
+		double lostIngest = metrics.value("frames_lost_total{" + label + ",stage=\"ingest\"}");
+		double lostCalculation = metrics.value("frames_lost_total{" + label + ",stage=\"calculation\"}");
+		double dropRate = sent > 0 ? (sent-processed)/sent : 0.0;
+		double latency99 = metrics.value("latency_seconds{" + label + ",stage=\"end_to_end\",quantile=\"0.99\"}")*1000.0;
+		processedFrames += processed;
+
+		out << source << ": sent " << static_cast<quint64>(sent) << " buffers (" << sent/seconds << " per s, " << generator->getLateBuffers() << " late), "
+			<< "received " << static_cast<quint64>(metrics.value("frames_received_total{" + label + "}")) << ", processed " << static_cast<quint64>(processed) << "\n";
+		out << "\tdrops: " << dropRate*100.0 << " % (lost in ingest " << static_cast<quint64>(lostIngest) << ", in calculation " << static_cast<quint64>(lostCalculation) << ")\n";
+		const LatencyHistogram& callLatency = generator->getCallLatency();
+		out << "\tcallback us: p50 " << callLatency.quantile(0.5) << ", p99 " << callLatency.quantile(0.99) << ", max " << generator->getMaxCallLatency() << "\n";
+		out << "\tend-to-end ms:";
+		const char* quantiles[][2] = {{"0.5", "p50"}, {"0.9", "p90"}, {"0.99", "p99"}, {"0.999", "p99.9"}};
+		for(const auto& quantile : quantiles){
+			out << " " << quantile[1] << " " << metrics.value("latency_seconds{" + label + ",stage=\"end_to_end\",quantile=\"" + quantile[0] + "\"}")*1000.0;
+		}
+		out << "\n";
+
+		if(this->parameters.maxDropRate >= 0 && dropRate > this->parameters.maxDropRate){
+			out << "\tFAIL: drop rate above " << this->parameters.maxDropRate*100.0 << " %\n";
+			passed = false;
+		}
+		if(this->parameters.maxLatencyMs >= 0 && latency99 > this->parameters.maxLatencyMs){
+			out << "\tFAIL: 99th percentile of end-to-end latency above " << this->parameters.maxLatencyMs << " ms\n";
+			passed = false;
+		}
+	}
+
+	double cpuMs = static_cast<double>(this->cpuTime)/1000.0;
+	out << "cpu: " << cpuMs << " ms total, " << (processedFrames > 0 ? cpuMs/processedFrames : 0.0) << " ms per processed frame, "
+		<< 100.0*static_cast<double>(this->cpuTime)/static_cast<double>(qMax(Q_INT64_C(1), this->wallTime)) << " % of one core\n";
+	out << "buffer pool: " << metrics.value("buffer_pool_bytes{state=\"total\"}")/1048576.0 << " MiB\n";
+	out << (passed ? "PASS" : "FAIL") << "\n";
+	out.flush();
+	return passed ? 0 : 2;
+}
+
+qint64 StubHost::processCpuTime() {
+	//user and system time of all threads of the process in microseconds
+#ifdef Q_OS_WIN
+	FILETIME creationTime, exitTime, kernelTime, userTime;
+	if(!GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime)){
+		return 0;
+	}
+	quint64 kernel = (static_cast<quint64>(kernelTime.dwHighDateTime) << 32) | kernelTime.dwLowDateTime;
+	quint64 user = (static_cast<quint64>(userTime.dwHighDateTime) << 32) | userTime.dwLowDateTime;
+	return static_cast<qint64>((kernel+user)/10);
+#else
+	struct rusage usage;
+	if(getrusage(RUSAGE_SELF, &usage) != 0){
+		return 0;
+	}
+	return (static_cast<qint64>(usage.ru_utime.tv_sec)+usage.ru_stime.tv_sec)*1000000 + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+#endif
+}
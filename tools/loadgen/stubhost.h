@@ -0,0 +1,84 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#ifndef STUBHOST_H
+#define STUBHOST_H
+
+#define LOADGEN_DRAIN_MS 1000 //time for the extension to process queued frames after the last buffer was sent
+
+#include <QObject>
+#include <QPluginLoader>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QTcpSocket>
+#include <QHash>
+#include "loadgenerator.h"
+
+//StubHost loads the extension plugin and drives it like OCTproZ: it passes settings, activates the extension, enables
+//data grabbing and lets one LoadGenerator per buffer source call the data callbacks. At the end of the run the
+//metrics endpoint of the extension is read and drops, latencies and cpu time per frame are reported.
+class StubHost : public QObject
+{
+	Q_OBJECT
+public:
+	explicit StubHost(QObject* parent = nullptr);
+	~StubHost();
+
+	bool load(const LoadParameters& parameters);
+	void start();
+
+private:
+	LoadParameters parameters;
+	QPluginLoader loader;
+	Extension* extension;
+	QWidget* widget;
+	QVector<LoadGenerator*> generators;
+	QTimer durationTimer;
+	QElapsedTimer wallTimer;
+	qint64 startCpuTime;
+	qint64 cpuTime;
+	qint64 wallTime;
+	QTcpSocket* metricsSocket;
+	QByteArray metricsResponse;
+
+	static qint64 processCpuTime();
+	static QHash<QByteArray, double> parseMetrics(const QByteArray& response);
+	int report(const QHash<QByteArray, double>& metrics);
+
+signals:
+	void info(QString);
+	void error(QString);
+	void finished(int exitCode);
+
+private slots:
+	void slot_stopLoad();
+	void slot_requestMetrics();
+	void slot_evaluateMetrics();
+};
+
+#endif // STUBHOST_H
@@ -0,0 +1,100 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTextStream>
+#include "replaydriver.h"
+
+
+static QRect parseRect(const QString& text) {
+	QStringList values = text.split(',');
+	if(values.size() != 4){
+		return QRect();
+	}
+	return QRect(values.at(0).toInt(), values.at(1).toInt(), values.at(2).toInt(), values.at(3).toInt());
+}
+
+int main(int argc, char* argv[]) {
+	QCoreApplication app(argc, argv);
+	QCoreApplication::setApplicationName("imagestatistics-replay");
+	qRegisterMetaType<FrameHandle>("FrameHandle");
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Replays an OCTproZ recording or a frame capture through the statistics pipeline of the Image Statistics Extension.");
+	parser.addHelpOption();
+	parser.addPositionalArgument("file", "Recording (raw data without header) or frame capture (*.cap).");
+	QCommandLineOption outputOption(QStringList() << "o" << "output", "Write statistics to <file> (.csv or binary, \"-\" for csv on standard output).", "file");
+	QCommandLineOption bitDepthOption("bitdepth", "Bit depth of a recording without header.", "bits");
+	QCommandLineOption samplesOption("samples", "Samples per line of a recording without header.", "samples");
+	QCommandLineOption linesOption("lines", "Lines per frame of a recording without header.", "lines");
+	QCommandLineOption sourceOption("source", "Buffer source of a recording without header: raw or processed.", "source", "processed");
+	QCommandLineOption rateOption("rate", "Replay with <fps> frames per second instead of as fast as possible.", "fps", "0");
+	QCommandLineOption loopsOption("loops", "Replay the recording <n> times.", "n", "1");
+	QCommandLineOption roiOption("roi", "Region of interest, default is the whole frame.", "x,y,width,height");
+	QCommandLineOption previewOption("preview", "Also convert a preview image of every frame with <width>x<height> pixels.", "size");
+	QCommandLineOption histogramOption("histograms", "Write histograms together with the statistics.");
+	parser.addOptions({outputOption, bitDepthOption, samplesOption, linesOption, sourceOption, rateOption, loopsOption, roiOption, previewOption, histogramOption});
+	parser.process(app);
+
+	QTextStream err(stderr);
+	if(parser.positionalArguments().size() != 1){
+		parser.showHelp(1);
+	}
+
+	ReplayParameters parameters;
+	parameters.inputFile = parser.positionalArguments().first();
+	parameters.outputFile = parser.value(outputOption);
+	parameters.source = parser.value(sourceOption).toLower() == "raw" ? RAW : PROCESSED;
+	parameters.bitDepth = parser.value(bitDepthOption).toUInt();
+	parameters.samplesPerLine = parser.value(samplesOption).toUInt();
+	parameters.linesPerFrame = parser.value(linesOption).toUInt();
+	parameters.rate = parser.value(rateOption).toDouble();
+	parameters.loops = parser.value(loopsOption).toInt();
+	parameters.roi = parseRect(parser.value(roiOption));
+	parameters.preview = parser.isSet(previewOption);
+	parameters.previewWidth = REPLAY_DEFAULT_PREVIEW_SIZE;
+	parameters.previewHeight = REPLAY_DEFAULT_PREVIEW_SIZE;
+	if(parameters.preview){
+		QStringList size = parser.value(previewOption).split('x');
+		if(size.size() == 2){
+			parameters.previewWidth = size.at(0).toInt();
+			parameters.previewHeight = size.at(1).toInt();
+		}
+	}
+	parameters.includeHistograms = parser.isSet(histogramOption);
+
+	//messages go to stderr, so statistics can be written to stdout
+	ReplayDriver driver;
+	QObject::connect(&driver, &ReplayDriver::info, [&err](QString message){err << message << "\n"; err.flush();});
+	QObject::connect(&driver, &ReplayDriver::error, [&err](QString message){err << "Error: " << message << "\n"; err.flush();});
+	if(!driver.open(parameters)){
+		return 1;
+	}
+	return driver.run() ? 0 : 1;
+}
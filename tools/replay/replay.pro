@@ -0,0 +1,19 @@
+QT	   = core
+CONFIG += console
+CONFIG -= app_bundle
+
+TARGET = imagestatistics-replay
+TEMPLATE = app
+
+DEFINES += \
+	QT_DEPRECATED_WARNINGS #emit warnings if depracted Qt features are used
+
+SOURCES += \
+	main.cpp \
+	replaydriver.cpp
+
+HEADERS += \
+	replaydriver.h
+
+#frames are processed by the same core library as in the plugin
+include(../../src/core/imagestatisticscore.pri)
@@ -0,0 +1,131 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#include "replaydriver.h"
+#include <QElapsedTimer>
+#include <QThread>
+
+
+ReplayDriver::ReplayDriver(QObject* parent) : QObject(parent)
+{
+	//the same objects as in the plugin, but all of them run on the calling thread and are connected directly. the ingest is created when the source is known
+	this->ingest = nullptr;
+	this->calculator = new ImageStatisticsCalculator(this);
+	this->converter = new BitDepthConverter(this);
+	this->recorder = new StatisticsRecorder(this);
+	this->converter->setTarget(&this->previewSink);
+	connect(this->calculator, &ImageStatisticsCalculator::error, this, &ReplayDriver::error);
+	connect(this->converter, &BitDepthConverter::error, this, &ReplayDriver::error);
+	connect(this->recorder, &StatisticsRecorder::error, this, &ReplayDriver::error);
+	connect(this->recorder, &StatisticsRecorder::info, this, &ReplayDriver::info);
+}
+
+ReplayDriver::~ReplayDriver()
+{
+	this->recorder->slot_stop();
+}
+
+bool ReplayDriver::open(const ReplayParameters& parameters) {
+	this->parameters = parameters;
+	if(!this->recording.open(parameters.inputFile, parameters.bitDepth, parameters.samplesPerLine, parameters.linesPerFrame, parameters.source)){
+		emit error(this->recording.getErrorString());
+		return false;
+	}
+	//frame captures contain their dimensions and source
+	this->parameters.bitDepth = this->recording.getBitDepth();
+	this->parameters.samplesPerLine = this->recording.getSamplesPerLine();
+	this->parameters.linesPerFrame = this->recording.getLinesPerFrame();
+	this->parameters.source = this->recording.getSource();
+
+	this->ingest = new FrameIngest(this->parameters.source, this);
+	this->calculator->setSource(this->parameters.source);
+	this->calculator->addSink(this->recorder);
+	connect(this->ingest, &FrameIngest::newRoiFrame, this->calculator, &ImageStatisticsCalculator::slot_calculateStatistics, Qt::DirectConnection);
+	connect(this->ingest, &FrameIngest::newPreviewFrame, this->converter, &BitDepthConverter::convertDataTo8bit, Qt::DirectConnection);
+	connect(this->ingest, &FrameIngest::info, this, &ReplayDriver::info);
+	connect(this->ingest, &FrameIngest::error, this, &ReplayDriver::error);
+
+	//every frame is passed to the ingest as a buffer with a single frame, so the statistics of all frames are calculated
+	QRect frameRect(0, 0, static_cast<int>(this->parameters.samplesPerLine), static_cast<int>(this->parameters.linesPerFrame));
+	QRect roi = this->parameters.roi.isEmpty() ? frameRect : this->parameters.roi;
+	this->ingest->setEnabled(true);
+	this->ingest->setBufferNr(-1);
+	this->ingest->setFrameNr(0);
+	this->ingest->setROI(roi.x(), roi.y(), roi.width(), roi.height());
+	this->ingest->setPreviewEnabled(this->parameters.preview);
+	this->ingest->setPreviewSize(this->parameters.previewWidth, this->parameters.previewHeight);
+	this->calculator->slot_setROI(roi.x(), roi.y(), roi.width(), roi.height());
+	if(!this->parameters.outputFile.isEmpty()){
+		this->recorder->slot_start(this->parameters.outputFile, this->parameters.includeHistograms);
+	}
+
+	emit info(tr("Replaying ") + QString::number(this->recording.getNumberOfFrames()) + tr(" frames of ") + QString::number(this->parameters.samplesPerLine) + "x" + QString::number(this->parameters.linesPerFrame) + tr(" samples with ") + QString::number(this->parameters.bitDepth) + tr(" bit"));
+	return true;
+}
+
+bool ReplayDriver::run() {
+	qint64 frameIntervalNs = this->parameters.rate > 0 ? static_cast<qint64>(1.0e9/this->parameters.rate) : 0;
+	quint64 replayedFrames = 0;
+	int binsPerFrame = StatisticsKernel::numberOfBins(this->parameters.bitDepth);
+	QElapsedTimer timer;
+	timer.start();
+	for(int loop = 0; loop < qMax(1, this->parameters.loops); loop++){
+		for(quint64 i = 0; i < this->recording.getNumberOfFrames(); i++){
+			if(frameIntervalNs > 0){
+				qint64 waitNs = static_cast<qint64>(replayedFrames)*frameIntervalNs - timer.nsecsElapsed();
+				if(waitNs > 0){
+					QThread::usleep(static_cast<unsigned long>(waitNs/1000));
+				}
+			}
+			//the recorder is flushed before its queues are full, an offline replay must not drop records
+			if(this->recorder->isRecording() && !this->recorder->hasSpaceFor(binsPerFrame)){
+				this->recorder->slot_flush();
+			}
+			void* frame = const_cast<void*>(this->recording.getFrame(i));
+			this->ingest->receiveBuffer(frame, this->parameters.bitDepth, this->parameters.samplesPerLine, this->parameters.linesPerFrame, 1, 1, 0);
+			replayedFrames++;
+			if(replayedFrames % REPLAY_FLUSH_INTERVAL == 0){
+				this->recorder->slot_flush();
+			}
+		}
+	}
+	quint64 droppedRecords = this->recorder->isRecording() ? this->recorder->getDroppedRecords() : 0;
+	this->recorder->slot_stop();
+
+	qreal seconds = timer.nsecsElapsed()/1.0e9;
+	qreal megabytes = static_cast<qreal>(replayedFrames)*this->recording.getBytesPerFrame()/1048576.0;
+	emit info(tr("Replayed frames: ") + QString::number(replayedFrames) + tr(", time: ") + QString::number(seconds, 'f', 3) + " s");
+	if(seconds > 0){
+		emit info(tr("Throughput: ") + QString::number(replayedFrames/seconds, 'f', 1) + tr(" frames/s, ") + QString::number(megabytes/seconds, 'f', 1) + " MiB/s, " + QString::number(seconds*1.0e6/qMax<quint64>(1, replayedFrames), 'f', 1) + tr(" us/frame"));
+	}
+	if(droppedRecords > 0){
+		emit error(tr("Dropped statistics records: ") + QString::number(droppedRecords));
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,97 @@
+/**
+**  This file is part of ImageStatisticsExtension for OCTproZ.
+**  ImageStatisticsExtension is a plugin for OCTproZ that displays
+**  image statistics such as a histogram of live acquired OCT data.
+**  Copyright (C) 2020 Miroslav Zabic
+**
+**  ImageStatisticsExtension is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program. If not, see http://www.gnu.org/licenses/.
+**
+****
+** Author:	Miroslav Zabic
+** Contact:	zabic
+**			at
+**			iqo.uni-hannover.de
+****
+**/
+
+
+#ifndef REPLAYDRIVER_H
+#define REPLAYDRIVER_H
+
+#define REPLAY_FLUSH_INTERVAL 1024 //recorded statistics are written after this number of frames
+#define REPLAY_DEFAULT_PREVIEW_SIZE 512
+
+#include <QObject>
+#include <QRect>
+#include <QVector>
+#include "frameingest.h"
+#include "imagestatisticscalculator.h"
+#include "bitdepthconverter.h"
+#include "statisticsrecorder.h"
+#include "recordingfile.h"
+
+struct ReplayParameters {
+	QString inputFile;
+	QString outputFile; //"-" for standard output, empty for no statistics output
+	BUFFER_SOURCE source;
+	unsigned int bitDepth; //only needed for recordings without capture header
+	unsigned int samplesPerLine;
+	unsigned int linesPerFrame;
+	double rate; //frames per second, 0 replays as fast as possible
+	int loops;
+	QRect roi; //empty roi evaluates whole frame
+	bool preview;
+	int previewWidth;
+	int previewHeight;
+	bool includeHistograms;
+};
+
+//preview sink that only keeps the converted image, so the conversion is done exactly like in the plugin
+class ReplayPreviewSink : public PreviewSink
+{
+public:
+	uchar* beginWrite(int width, int height) override {this->buffer.resize(width*height); return this->buffer.data();}
+	void endWrite() override {}
+
+private:
+	QVector<uchar> buffer;
+};
+
+//ReplayDriver memory-maps an OCTproZ recording or a frame capture and pushes every frame through FrameIngest,
+//ImageStatisticsCalculator and (optionally) BitDepthConverter on the calling thread.
+class ReplayDriver : public QObject
+{
+	Q_OBJECT
+public:
+	explicit ReplayDriver(QObject* parent = nullptr);
+	~ReplayDriver();
+
+	bool open(const ReplayParameters& parameters);
+	bool run();
+
+private:
+	ReplayParameters parameters;
+	RecordingFile recording;
+	FrameIngest* ingest;
+	ImageStatisticsCalculator* calculator;
+	BitDepthConverter* converter;
+	StatisticsRecorder* recorder;
+	ReplayPreviewSink previewSink;
+
+signals:
+	void info(QString);
+	void error(QString);
+};
+
+#endif // REPLAYDRIVER_H